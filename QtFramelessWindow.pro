@@ -3,5 +3,6 @@ TEMPLATE = subdirs
 # 当使用subdirs模板时，此选项指定应按给出目录的顺序处理列出的目录
 CONFIG += ordered
 
-SUBDIRS += libtest
+SUBDIRS += libtest \
+    bench
 
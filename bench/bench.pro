@@ -0,0 +1,11 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    shadowgenerator \
+    hittest \
+    framelesswindow \
+    inputtrace \
+    titlebar \
+    messagebox \
+    mpscqueue \
+    theme
@@ -0,0 +1,115 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * benchmain.cpp
+ * 运行QtTest并把xml日志中的BenchmarkResult转换为JSON。
+ *
+ */
+
+#include "benchmain.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QXmlStreamReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QGuiApplication>
+#include <QSysInfo>
+#include <QDateTime>
+
+namespace {
+
+// 从QtTest的xml日志中取出所有性能测试结果
+QJsonArray readBenchmarkResults(const QString &xmlFile, QString *testCase)
+{
+    QJsonArray results;
+    QFile file(xmlFile);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return results;
+    }
+
+    QString function;
+    QXmlStreamReader xml(&file);
+    while(!xml.atEnd()) {
+        if(xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+
+        const QXmlStreamAttributes attributes = xml.attributes();
+        if(xml.name() == QLatin1String("TestCase")) {
+            *testCase = attributes.value(QLatin1String("name")).toString();
+        } else if(xml.name() == QLatin1String("TestFunction")) {
+            function = attributes.value(QLatin1String("name")).toString();
+        } else if(xml.name() == QLatin1String("BenchmarkResult")) {
+            QJsonObject result;
+            result.insert("function", function);
+            result.insert("tag", attributes.value(QLatin1String("tag")).toString());
+            result.insert("metric", attributes.value(QLatin1String("metric")).toString());
+            // QtTest记录的是每次迭代的平均值
+            result.insert("value", attributes.value(QLatin1String("value")).toDouble());
+            result.insert("iterations", attributes.value(QLatin1String("iterations")).toInt());
+            results.append(result);
+        }
+    }
+    return results;
+}
+
+} // namespace
+
+void BenchMain::useOffscreenPlatform()
+{
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+}
+
+int BenchMain::exec(QObject *testObject)
+{
+    QStringList args = QCoreApplication::arguments();
+
+    QString jsonFile = QString::fromLocal8Bit(qgetenv("FRAMELESS_BENCH_JSON"));
+    const int jsonIndex = args.indexOf("-json");
+    if(jsonIndex > 0 && jsonIndex + 1 < args.size()) {
+        jsonFile = args.at(jsonIndex + 1);
+        args.erase(args.begin() + jsonIndex, args.begin() + jsonIndex + 2);
+    }
+    if(jsonFile.isEmpty()) {
+        jsonFile = QFileInfo(QCoreApplication::applicationFilePath()).completeBaseName() + ".json";
+    }
+
+    QTemporaryFile xmlFile;
+    if(!xmlFile.open()) {
+        qWarning("bench: cannot create temporary file, JSON output disabled");
+        return QTest::qExec(testObject, args);
+    }
+    xmlFile.close();
+
+    // 保留控制台输出，同时写一份xml日志
+    if(!args.contains("-o")) {
+        args << "-o" << "-,txt";
+    }
+    args << "-o" << xmlFile.fileName() + ",xml";
+
+    const int ret = QTest::qExec(testObject, args);
+
+    QJsonObject root;
+    QString testCase;
+    const QJsonArray results = readBenchmarkResults(xmlFile.fileName(), &testCase);
+    root.insert("testCase", testCase);
+    root.insert("qtVersion", QString::fromLatin1(qVersion()));
+    root.insert("platform", QGuiApplication::platformName());
+    root.insert("cpu", QSysInfo::currentCpuArchitecture());
+    root.insert("os", QSysInfo::prettyProductName());
+    root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("passed", ret == 0);
+    root.insert("results", results);
+
+    QFile out(jsonFile);
+    if(out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        out.write(QJsonDocument(root).toJson());
+    } else {
+        qWarning("bench: cannot write %s", qPrintable(jsonFile));
+    }
+    return ret;
+}
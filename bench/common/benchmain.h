@@ -0,0 +1,49 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * benchmain.h
+ * 性能测试的入口，除了QtTest自身的输出，还把所有BenchmarkResult导出为JSON，便于对比不同版本。
+ *
+ */
+
+#ifndef BENCHMAIN_H
+#define BENCHMAIN_H
+
+#include <QtTest>
+#include <QApplication>
+
+class QObject;
+
+namespace BenchMain {
+
+/**
+ * @brief exec
+ * @note 运行测试对象。命令行参数"-json <file>"或环境变量FRAMELESS_BENCH_JSON指定JSON文件，
+ *  默认写到当前目录下的"<程序名>.json"；其余参数原样交给QTest::qExec
+ * @return QTest::qExec的返回值
+ */
+int exec(QObject *testObject);
+
+/**
+ * @brief useOffscreenPlatform
+ * @note 没有指定QT_QPA_PLATFORM时使用offscreen，在没有显示器的机器上也能运行
+ */
+void useOffscreenPlatform();
+
+} // namespace BenchMain
+
+/**
+ * 替代QTEST_MAIN，额外导出JSON结果
+ */
+#define FRAMELESS_BENCH_MAIN(TestObject) \
+int main(int argc, char *argv[]) \
+{ \
+    BenchMain::useOffscreenPlatform(); \
+    QApplication app(argc, argv); \
+    app.setAttribute(Qt::AA_Use96Dpi, true); \
+    TestObject tc; \
+    QTEST_SET_MAIN_SOURCE_PATH \
+    return BenchMain::exec(&tc); \
+}
+
+#endif // BENCHMAIN_H
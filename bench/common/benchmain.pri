@@ -0,0 +1,11 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+HEADERS += \
+    $$PWD/benchmain.h
+
+SOURCES += \
+    $$PWD/benchmain.cpp
+
+# qmake CONFIG+=tsan 用ThreadSanitizer编译(gcc/clang)，检查多线程测试中的数据竞争
+tsan: CONFIG += sanitizer sanitize_thread
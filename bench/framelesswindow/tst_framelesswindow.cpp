@@ -0,0 +1,205 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_framelesswindow.cpp
+ * 窗体构造、首次绘制、缩放后绘制、命中测试、按钮绘制和提示框弹出的耗时，
+ * 可以在QT_QPA_PLATFORM=offscreen下运行，结果同时导出为JSON。
+ *
+ */
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QPointer>
+#include "benchmain.h"
+#include "framelesswindow.h"
+#include "cursorposcalculator.h"
+#include "statebutton.h"
+
+namespace {
+
+const int kPaintTimeout = 5000;
+
+// 处理事件直到窗体完成第一次绘制
+bool waitForFirstPaint(FramelessWindow *window)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while(window->paintStatistics().frames == 0 && timer.elapsed() < kPaintTimeout) {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return window->paintStatistics().frames > 0;
+}
+
+/**
+ * @brief The FirstPaintCloser class
+ *  应用程序级事件过滤器，提示框第一次绘制时记录耗时并关闭提示框，让exec()返回
+ */
+class FirstPaintCloser : public QObject
+{
+public:
+    FirstPaintCloser() : m_bPainted(false), m_nNsecs(0) {}
+
+    void start()
+    {
+        m_bPainted = false;
+        m_nNsecs = 0;
+        m_timer.start();
+    }
+
+    bool painted() const { return m_bPainted; }
+    qint64 nsecs() const { return m_nNsecs; }
+
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event)
+    {
+        if(!m_bPainted && event->type() == QEvent::Paint) {
+            if(FramelessMessageBox *box = qobject_cast<FramelessMessageBox *>(obj)) {
+                m_bPainted = true;
+                m_nNsecs = m_timer.nsecsElapsed();
+                QMetaObject::invokeMethod(box, "reject", Qt::QueuedConnection);
+            }
+        }
+        return QObject::eventFilter(obj, event);
+    }
+
+private:
+    QElapsedTimer m_timer;
+    bool m_bPainted;
+    qint64 m_nNsecs;
+};
+
+} // namespace
+
+class tst_FramelessWindow : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void construct();
+    void firstPaint();
+    void paintAfterResize_data();
+    void paintAfterResize();
+    void cursorPosCalculator();
+    void stateButtonPaint();
+    void messageBoxFirstPaint_data();
+    void messageBoxFirstPaint();
+};
+
+void tst_FramelessWindow::construct()
+{
+    QBENCHMARK {
+        FramelessWindow window;
+        Q_UNUSED(window)
+    }
+}
+
+void tst_FramelessWindow::firstPaint()
+{
+    QBENCHMARK {
+        FramelessWindow window;
+        window.resize(800, 600);
+        window.show();
+        QVERIFY(waitForFirstPaint(&window));
+    }
+}
+
+void tst_FramelessWindow::paintAfterResize_data()
+{
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("800x600") << QSize(800, 600);
+    QTest::newRow("1920x1080") << QSize(1920, 1080);
+    QTest::newRow("3840x2160") << QSize(3840, 2160);
+}
+
+void tst_FramelessWindow::paintAfterResize()
+{
+    QFETCH(QSize, size);
+
+    FramelessWindow window;
+    window.resize(size);
+    window.show();
+    QVERIFY(waitForFirstPaint(&window));
+
+    //每次迭代都改变大小，重建背景缓存后同步重绘整个窗体
+    const QSize other = size - QSize(1, 1);
+    bool toggle = false;
+    QBENCHMARK {
+        toggle = !toggle;
+        window.resize(toggle ? other : size);
+        window.repaint();
+    }
+}
+
+void tst_FramelessWindow::cursorPosCalculator()
+{
+    const QRect frameRect(0, 0, 800, 600);
+    CursorPosCalculator calculator;
+
+    //依次经过左上角、上边、客户区、右边、右下角
+    const QPoint points[] = {
+        QPoint(2, 2), QPoint(400, 2), QPoint(400, 300), QPoint(798, 300), QPoint(798, 598)
+    };
+    const int count = int(sizeof(points) / sizeof(points[0]));
+
+    int edges = 0;
+    QBENCHMARK {
+        for(int i = 0; i < count; ++i) {
+            calculator.recalculate(points[i], frameRect);
+            edges += calculator.m_bOnEdges;
+        }
+    }
+    QVERIFY(edges > 0);
+}
+
+void tst_FramelessWindow::stateButtonPaint()
+{
+    StateButton button;
+    button.setPixmap(QPixmap(":/images/titlebar/close.png"));
+    button.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&button));
+
+    QBENCHMARK {
+        button.repaint();
+    }
+}
+
+void tst_FramelessWindow::messageBoxFirstPaint_data()
+{
+    QTest::addColumn<int>("poolSize");
+
+    QTest::newRow("unpooled") << 0;
+    QTest::newRow("pooled") << 2;
+}
+
+void tst_FramelessWindow::messageBoxFirstPaint()
+{
+    QFETCH(int, poolSize);
+
+    //池中的提示框在计时前创建好，和程序启动时调用prewarmPool()一样
+    const int defaultPoolSize = FramelessMessageBox::poolSize();
+    FramelessMessageBox::setPoolSize(poolSize);
+    FramelessMessageBox::prewarmPool();
+
+    FirstPaintCloser closer;
+    qApp->installEventFilter(&closer);
+
+    const int rounds = 20;
+    qint64 total = 0;
+    for(int i = 0; i < rounds; ++i) {
+        closer.start();
+        FramelessMessageBox::showInformation(nullptr, "Tip", "Benchmark message");
+        QVERIFY(closer.painted());
+        total += closer.nsecs();
+    }
+
+    qApp->removeEventFilter(&closer);
+    FramelessMessageBox::setPoolSize(defaultPoolSize);
+
+    //从调用showInformation(构造或从池中取出)到第一次绘制的平均耗时
+    QTest::setBenchmarkResult(total / 1e6 / rounds, QTest::WalltimeMilliseconds);
+}
+
+FRAMELESS_BENCH_MAIN(tst_FramelessWindow)
+
+#include "tst_framelesswindow.moc"
@@ -0,0 +1,146 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_hittest.cpp
+ * 命中测试的吞吐量：HitTester与CursorPosCalculator对比。
+ *
+ */
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include "benchmain.h"
+#include "hittester.h"
+#include "cursorposcalculator.h"
+
+namespace {
+
+const QSize kWindowSize(800, 600);
+const int kSamples = 100000;
+
+//在窗口及其周围均匀取点，边框、标题栏、客户区都有覆盖
+QVector<QPoint> samplePoints()
+{
+    QVector<QPoint> points;
+    points.reserve(kSamples);
+    quint32 seed = 12345;
+    for(int i = 0; i < kSamples; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        const int x = int((seed >> 8) % uint(kWindowSize.width() + 20)) - 10;
+        seed = seed * 1103515245u + 12345u;
+        const int y = int((seed >> 8) % uint(kWindowSize.height() + 20)) - 10;
+        points.append(QPoint(x, y));
+    }
+    return points;
+}
+
+} // namespace
+
+class tst_HitTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void edgeWidths();
+    void hitTester();
+    void hitTesterExtraRects();
+    void cursorPosCalculator();
+    void hitTestsPerSecond();
+};
+
+void tst_HitTest::edgeWidths()
+{
+    //与原来的CursorPosCalculator一致：左、上两边包含第border个像素，右、下两边从width - border开始
+    const int border = 8;
+    const int w = kWindowSize.width();
+    const int h = kWindowSize.height();
+    HitTester tester;
+    tester.setBorderWidth(border);
+    tester.setTitleHeight(1);
+
+    QCOMPARE(tester.hitTest(QPoint(border, h / 2), kWindowSize), HitTester::Left);
+    QCOMPARE(tester.hitTest(QPoint(border + 1, h / 2), kWindowSize), HitTester::Client);
+    QCOMPARE(tester.hitTest(QPoint(w - border, h / 2), kWindowSize), HitTester::Right);
+    QCOMPARE(tester.hitTest(QPoint(w - border - 1, h / 2), kWindowSize), HitTester::Client);
+    QCOMPARE(tester.hitTest(QPoint(w / 2, border), kWindowSize), HitTester::Top);
+    QCOMPARE(tester.hitTest(QPoint(w / 2, h - border), kWindowSize), HitTester::Bottom);
+    QCOMPARE(tester.hitTest(QPoint(border, border), kWindowSize), HitTester::TopLeft);
+    QCOMPARE(tester.hitTest(QPoint(w, h / 2), kWindowSize), HitTester::Outside);
+}
+
+void tst_HitTest::hitTester()
+{
+    const QVector<QPoint> points = samplePoints();
+    HitTester tester;
+    tester.setBorderWidth(8);
+
+    int edges = 0;
+    QBENCHMARK {
+        for(int i = 0; i < points.size(); ++i) {
+            edges += HitTester::isEdge(tester.hitTest(points.at(i), kWindowSize));
+        }
+    }
+    QVERIFY(edges > 0);
+}
+
+void tst_HitTest::hitTesterExtraRects()
+{
+    const QVector<QPoint> points = samplePoints();
+    HitTester tester;
+    tester.setBorderWidth(8);
+    //标题栏上的三个按钮，以及一块额外的标题栏区域
+    tester.addClientRect(QRect(700, 8, 30, 30));
+    tester.addClientRect(QRect(730, 8, 30, 30));
+    tester.addClientRect(QRect(760, 8, 30, 30));
+    tester.addCaptionRect(QRect(8, 38, 200, 20));
+
+    int captions = 0;
+    QBENCHMARK {
+        for(int i = 0; i < points.size(); ++i) {
+            captions += (tester.hitTest(points.at(i), kWindowSize) == HitTester::Caption);
+        }
+    }
+    QVERIFY(captions > 0);
+}
+
+void tst_HitTest::cursorPosCalculator()
+{
+    const QVector<QPoint> points = samplePoints();
+    const QRect frameRect(QPoint(0, 0), kWindowSize);
+    CursorPosCalculator calculator;
+    calculator.m_nBorderWidth = 8;
+
+    int edges = 0;
+    QBENCHMARK {
+        for(int i = 0; i < points.size(); ++i) {
+            calculator.recalculate(points.at(i), frameRect);
+            edges += calculator.m_bOnEdges;
+        }
+    }
+    QVERIFY(edges > 0);
+}
+
+void tst_HitTest::hitTestsPerSecond()
+{
+    const QVector<QPoint> points = samplePoints();
+    HitTester tester;
+    tester.setBorderWidth(8);
+
+    const int rounds = 50;
+    int edges = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for(int r = 0; r < rounds; ++r) {
+        for(int i = 0; i < points.size(); ++i) {
+            edges += HitTester::isEdge(tester.hitTest(points.at(i), kWindowSize));
+        }
+    }
+    const qint64 nsecs = qMax(Q_INT64_C(1), timer.nsecsElapsed());
+    QVERIFY(edges > 0);
+
+    //按每秒命中测试次数上报
+    QTest::setBenchmarkResult(qreal(rounds) * points.size() * 1e9 / nsecs, QTest::Events);
+}
+
+FRAMELESS_BENCH_MAIN(tst_HitTest)
+
+#include "tst_hittest.moc"
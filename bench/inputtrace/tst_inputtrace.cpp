@@ -0,0 +1,206 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_inputtrace.cpp
+ * 回放拖动、缩放的鼠标事件流，统计每个事件的处理耗时、窗体位置大小改变次数和绘制次数。
+ * 环境变量FRAMELESS_TRACE指定录制的文件时回放该文件，否则回放内置的拖动加缩放轨迹。
+ *
+ */
+
+#include <QtTest>
+#include <QBuffer>
+#include <QHash>
+#include "benchmain.h"
+#include "framelesswindow.h"
+#include "framelesshelper.h"
+#include "inputtrace.h"
+
+namespace {
+
+const QSize kWindowSize(800, 600);
+const qint64 kMoveInterval = 8000; // 微秒，125Hz的鼠标
+const qint64 kHeaderBytes = 18;     // 魔数、版本、窗体大小、事件数
+const qint64 kEventBytes = 16;
+
+class TraceBuilder
+{
+public:
+    TraceBuilder() : m_nTime(0) {}
+
+    // 移动一次会同时收到MouseMove和HoverMove
+    void move(const QPoint &pos, Qt::MouseButtons buttons)
+    {
+        add(InputTraceEvent::MouseMove, pos, Qt::NoButton, buttons);
+        add(InputTraceEvent::HoverMove, pos, Qt::NoButton, Qt::NoButton);
+        m_nTime += kMoveInterval;
+    }
+
+    void drag(const QPoint &from, const QPoint &to, int steps)
+    {
+        for(int i = 0; i <= 10; ++i) {
+            move(from + QPoint(i * 2, 0) - QPoint(20, 0), Qt::NoButton);
+        }
+        add(InputTraceEvent::MousePress, from, Qt::LeftButton, Qt::LeftButton);
+        for(int i = 1; i <= steps; ++i) {
+            move(from + (to - from) * i / steps, Qt::LeftButton);
+        }
+        add(InputTraceEvent::MouseRelease, to, Qt::LeftButton, Qt::NoButton);
+        m_nTime += kMoveInterval;
+    }
+
+    InputTrace trace() const { return m_trace; }
+
+private:
+    void add(InputTraceEvent::Type type, const QPoint &pos, Qt::MouseButton button, Qt::MouseButtons buttons)
+    {
+        InputTraceEvent event;
+        event.type = type;
+        event.button = quint8(button);
+        event.buttons = quint8(buttons);
+        event.time = m_nTime;
+        event.pos = pos;
+        m_trace.append(event);
+    }
+
+private:
+    InputTrace m_trace;
+    qint64 m_nTime;
+};
+
+// 拖动标题栏移动窗体，再拖动右下角放大窗体。
+// 位置相对录制开始时的窗体原点，第二次拖动要加上第一次移动的距离
+InputTrace builtinTrace()
+{
+    const QPoint moved(200, 200);
+    TraceBuilder builder;
+    builder.drag(QPoint(400, 15), QPoint(400, 15) + moved, 150);
+    builder.drag(QPoint(798, 598) + moved, QPoint(1100, 800) + moved, 150);
+
+    InputTrace trace = builder.trace();
+    trace.setWindowSize(kWindowSize);
+    return trace;
+}
+
+} // namespace
+
+class tst_InputTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void saveLoad();
+    void recorder();
+    void replay_data();
+    void replay();
+
+private:
+    InputTrace m_trace;
+    bool m_bBuiltinTrace;
+    QHash<int, int> m_directGeometryChanges; // 速度 -> 不合并时的位置大小改变次数
+};
+
+void tst_InputTrace::initTestCase()
+{
+    const QString fileName = QString::fromLocal8Bit(qgetenv("FRAMELESS_TRACE"));
+    m_bBuiltinTrace = fileName.isEmpty();
+    if(!fileName.isEmpty()) {
+        QVERIFY2(m_trace.load(fileName), qPrintable(fileName));
+    } else {
+        m_trace = builtinTrace();
+    }
+    QVERIFY(!m_trace.events().isEmpty());
+}
+
+void tst_InputTrace::saveLoad()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    QVERIFY(m_trace.save(&buffer));
+    QCOMPARE(buffer.size(), kHeaderBytes + kEventBytes * m_trace.events().size());
+
+    buffer.seek(0);
+    InputTrace loaded;
+    QVERIFY(loaded.load(&buffer));
+    QCOMPARE(loaded.windowSize(), m_trace.windowSize());
+    QCOMPARE(loaded.events().size(), m_trace.events().size());
+    QCOMPARE(loaded.duration(), m_trace.duration());
+}
+
+void tst_InputTrace::recorder()
+{
+    //回放到装有录制器的窗体上，录制得到的事件应与回放的一致
+    FramelessWindow window;
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    InputTraceRecorder recorder;
+    window.framelessHelper()->setInputTraceRecorder(&recorder);
+    recorder.start(&window);
+
+    InputTraceReplayer replayer;
+    replayer.replay(m_trace, &window, InputTraceReplayer::MaximumSpeed);
+
+    recorder.stop();
+    window.framelessHelper()->setInputTraceRecorder(nullptr);
+
+    QCOMPARE(recorder.trace().events().size(), m_trace.events().size());
+}
+
+void tst_InputTrace::replay_data()
+{
+    QTest::addColumn<bool>("coalescing");
+    QTest::addColumn<int>("speed");
+
+    QTest::newRow("direct-max") << false << int(InputTraceReplayer::MaximumSpeed);
+    QTest::newRow("coalesced-max") << true << int(InputTraceReplayer::MaximumSpeed);
+    QTest::newRow("direct-original") << false << int(InputTraceReplayer::OriginalSpeed);
+    QTest::newRow("coalesced-original") << true << int(InputTraceReplayer::OriginalSpeed);
+}
+
+void tst_InputTrace::replay()
+{
+    QFETCH(bool, coalescing);
+    QFETCH(int, speed);
+
+    FramelessWindow window;
+    window.setResizeCoalescing(coalescing);
+    window.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+    //分阶段耗时，区分时间花在绘制、遮罩还是移动缩放上
+    FrameProfiler::setEnabled(true);
+    window.frameProfiler()->setName(QTest::currentDataTag());
+
+    InputTraceReplayer replayer;
+    const InputTraceReport report = replayer.replay(m_trace, &window, InputTraceReplayer::Speed(speed));
+    QCOMPARE(report.eventNsecs.size(), m_trace.events().size());
+
+    window.frameProfiler()->logSummary();
+    FrameProfiler::setEnabled(false);
+
+    //内置轨迹的第二次拖动在右下角，窗体应被放大
+    if(m_bBuiltinTrace) {
+        QTRY_VERIFY(window.width() > kWindowSize.width() && window.height() > kWindowSize.height());
+    }
+
+    QVERIFY(report.geometryChanges > 0);
+    QVERIFY(report.repaints > 0);
+
+    //合并缩放时位置大小的改变不应多于同样速度下直接处理的次数
+    if(!coalescing) {
+        m_directGeometryChanges.insert(speed, report.geometryChanges);
+    } else if(m_directGeometryChanges.contains(speed)) {
+        QVERIFY2(report.geometryChanges <= m_directGeometryChanges.value(speed),
+                 qPrintable(QString("%1 > %2").arg(report.geometryChanges)
+                            .arg(m_directGeometryChanges.value(speed))));
+    }
+
+    //每个事件的平均处理耗时
+    QTest::setBenchmarkResult(report.averageEventNsecs() / 1e6, QTest::WalltimeMilliseconds);
+}
+
+FRAMELESS_BENCH_MAIN(tst_InputTrace)
+
+#include "tst_inputtrace.moc"
@@ -0,0 +1,363 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_messagebox.cpp
+ * 异步提示框：弹出期间GUI线程的定时器是否按时触发，以及同步接口的结果；
+ * 通知队列：突发10000条通知时的合并效果、内存上限和GUI线程响应，单独的提示框关闭后补满；
+ * 超长文字：从弹出到第一次绘制的耗时不随文字长度增长。
+ *
+ */
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include "benchmain.h"
+#include "framelesswindow.h"
+#include "notificationqueue.h"
+
+namespace {
+
+const int kTimerInterval = 10;    // 毫秒
+const int kOpenDuration = 500;    // 提示框显示的时间(毫秒)
+const int kBurstMessages = 10000; // 突发通知条数
+
+FramelessMessageBox *activeMessageBox()
+{
+    return qobject_cast<FramelessMessageBox *>(QApplication::activeModalWidget());
+}
+
+// 定时器每次触发的时间，用来计算GUI线程的最大停顿
+class TickRecorder
+{
+public:
+    TickRecorder()
+    {
+        m_timer.setTimerType(Qt::PreciseTimer);
+        m_timer.setInterval(kTimerInterval);
+        QObject::connect(&m_timer, &QTimer::timeout, [this] {
+            m_ticks.append(m_clock.elapsed());
+        });
+    }
+
+    void start()
+    {
+        m_ticks.clear();
+        m_clock.start();
+        m_timer.start();
+    }
+
+    void stop() { m_timer.stop(); }
+    int count() const { return m_ticks.size(); }
+
+    qint64 maxGap() const
+    {
+        qint64 gap = m_ticks.isEmpty() ? m_clock.elapsed() : m_ticks.first();
+        for(int i = 1; i < m_ticks.size(); ++i) {
+            gap = qMax(gap, m_ticks.at(i) - m_ticks.at(i - 1));
+        }
+        return gap;
+    }
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    QVector<qint64> m_ticks;
+};
+
+// 提示框第一次绘制时记录耗时
+class FirstPaintWatcher : public QObject
+{
+public:
+    FirstPaintWatcher() : m_nNsecs(-1) { m_timer.start(); }
+
+    qint64 nsecs() const { return m_nNsecs; }
+
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event)
+    {
+        if(m_nNsecs < 0 && event->type() == QEvent::Paint && qobject_cast<FramelessMessageBox *>(obj)) {
+            m_nNsecs = m_timer.nsecsElapsed();
+        }
+        return QObject::eventFilter(obj, event);
+    }
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_nNsecs;
+};
+
+// 生成大约size个字符的调用栈文字
+QString stackTrace(int size)
+{
+    QString text;
+    text.reserve(size + 64);
+    for(int frame = 0; text.size() < size; ++frame) {
+        text += QString("#%1 0x%2 in OrderBook::apply(const Update &) at orderbook.cpp:%3\n")
+                .arg(frame).arg(0x400000 + frame * 16, 0, 16).arg(100 + frame % 900);
+    }
+    return text;
+}
+
+// 通知队列单独显示的提示框(不含带列表的汇总框)
+QList<FramelessMessageBox *> notificationBoxes()
+{
+    QList<FramelessMessageBox *> boxes;
+    foreach(QWidget *widget, QApplication::topLevelWidgets()) {
+        FramelessMessageBox *box = qobject_cast<FramelessMessageBox *>(widget);
+        if(box && box->isVisible() && !box->findChild<QPlainTextEdit *>()) {
+            boxes << box;
+        }
+    }
+    return boxes;
+}
+
+// 点击当前提示框上的按钮
+bool clickButton(QDialogButtonBox::StandardButton which)
+{
+    FramelessMessageBox *box = activeMessageBox();
+    if(!box) {
+        return false;
+    }
+    QDialogButtonBox *buttonBox = box->findChild<QDialogButtonBox *>();
+    QPushButton *button = buttonBox ? buttonBox->button(which) : Q_NULLPTR;
+    if(!button) {
+        return false;
+    }
+    button->click();
+    return true;
+}
+
+} // namespace
+
+class tst_MessageBox : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void asyncFuture();
+    void asyncCallback();
+    void blockingWrapper();
+    void timersKeepFiring();
+    void notificationBurst();
+    void notificationPromotion();
+    void hugeTextFirstPaint_data();
+    void hugeTextFirstPaint();
+    void detailLoadsLazily();
+};
+
+void tst_MessageBox::asyncFuture()
+{
+    QFuture<QMessageBox::StandardButton> future = FramelessMessageBox::showAsync(nullptr, "Tip", "Async message",
+            QMessageBox::Yes | QMessageBox::No, FramelessMessageBox::MSG_QUESTION);
+    QVERIFY(!future.isFinished());
+    QTRY_VERIFY(activeMessageBox() != Q_NULLPTR);
+
+    QVERIFY(clickButton(QDialogButtonBox::No));
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.result(), QMessageBox::No);
+}
+
+void tst_MessageBox::asyncCallback()
+{
+    QMessageBox::StandardButton result = QMessageBox::NoButton;
+    int calls = 0;
+    FramelessMessageBox::showAsync(nullptr, "Tip", "Async message",
+    [&](QMessageBox::StandardButton button) {
+        result = button;
+        ++calls;
+    });
+    QTRY_VERIFY(activeMessageBox() != Q_NULLPTR);
+    QCOMPARE(calls, 0);
+
+    QVERIFY(clickButton(QDialogButtonBox::Ok));
+    QTRY_COMPARE(calls, 1);
+    QCOMPARE(result, QMessageBox::Ok);
+}
+
+void tst_MessageBox::blockingWrapper()
+{
+    //同步接口在局部事件循环中等待，由定时器点击按钮
+    QTimer::singleShot(50, [] {
+        clickButton(QDialogButtonBox::Yes);
+    });
+    const QMessageBox::StandardButton result = FramelessMessageBox::showQuestion(nullptr, "Tip", "Blocking message");
+    QCOMPARE(result, QMessageBox::Yes);
+}
+
+void tst_MessageBox::timersKeepFiring()
+{
+    TickRecorder ticks;
+
+    //先开始计时，提示框的构造和显示(可能卡住GUI线程的部分)也算在内
+    ticks.start();
+    QFuture<QMessageBox::StandardButton> future = FramelessMessageBox::showAsync(nullptr, "Tip", "Async message",
+            QMessageBox::Ok, FramelessMessageBox::MSG_ERROR);
+
+    //showAsync已经返回，定时器在调用方自己的事件循环中运行
+    QTest::qWait(kOpenDuration);
+    ticks.stop();
+
+    QVERIFY(activeMessageBox() != Q_NULLPTR);
+    QVERIFY(!future.isFinished());
+    QMetaObject::invokeMethod(activeMessageBox(), "reject", Qt::QueuedConnection);
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.result(), QMessageBox::NoButton);
+
+    const qint64 maxGap = ticks.maxGap();
+
+    //弹出提示框(包括构造和第一次绘制)不能让定时器停顿，允许正常的调度误差
+    QVERIFY(ticks.count() >= kOpenDuration / kTimerInterval * 8 / 10);
+    QVERIFY(maxGap < kTimerInterval * 10);
+
+    //按提示框打开期间定时器的最大间隔上报
+    QTest::setBenchmarkResult(maxGap, QTest::WalltimeMilliseconds);
+}
+
+void tst_MessageBox::notificationBurst()
+{
+    NotificationQueue queue;
+    queue.setMaxVisible(3);
+
+    TickRecorder ticks;
+    ticks.start();
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int i = 0; i < kBurstMessages; ++i) {
+        //大部分是重复的后端错误，五分之一各不相同
+        const QString text = (i % 5 == 0) ? QString("Order %1 rejected").arg(i)
+                             : QString("Backend error %1").arg(i % 20);
+        queue.post("Error", text);
+        //调用方自己的事件循环照常运行
+        if(i % 100 == 99) {
+            QCoreApplication::processEvents();
+        }
+    }
+    const qint64 postNsecs = timer.nsecsElapsed();
+
+    //等合并后的刷新完成
+    QTest::qWait(queue.coalesceInterval() * 3);
+    ticks.stop();
+
+    const NotificationStatistics stats = queue.statistics();
+    QCOMPARE(stats.posted, qint64(kBurstMessages));
+    QVERIFY(stats.deduplicated > 0);
+    QVERIFY(stats.dropped > 0);
+    //每条通知只会被合并、单独显示、放入汇总框或丢弃其中之一
+    QCOMPARE(stats.deduplicated + queue.visibleCount() + stats.summarized + stats.dropped, stats.posted);
+    QCOMPARE(stats.summarized, qint64(queue.maxSummaryEntries()));
+    //刷新按时间合并，远少于通知数
+    QVERIFY(stats.flushes > 0);
+    QVERIFY(stats.flushes < kBurstMessages / 100);
+    //单独的提示框和保存的通知都有上限
+    QVERIFY(stats.boxesShown <= queue.maxVisible());
+    QVERIFY(queue.visibleCount() <= queue.maxVisible());
+    QVERIFY(queue.pendingCount() <= queue.maxVisible() + queue.maxSummaryEntries());
+    QVERIFY(ticks.maxGap() < kTimerInterval * 10);
+
+    queue.clear();
+
+    //平均每条通知的post耗时
+    QTest::setBenchmarkResult(postNsecs / 1e6 / kBurstMessages, QTest::WalltimeMilliseconds);
+}
+
+void tst_MessageBox::notificationPromotion()
+{
+    NotificationQueue queue;
+    queue.setMaxVisible(1);
+    //文字中的%1不能被次数替换
+    queue.post("Error", "first");
+    queue.post("Error", "second %1");
+    queue.post("Error", "second %1");
+    queue.post("Error", "third");
+    queue.flush();
+
+    QCOMPARE(queue.visibleCount(), 1);
+    QCOMPARE(queue.statistics().summarized, qint64(2));
+    QList<FramelessMessageBox *> boxes = notificationBoxes();
+    QCOMPARE(boxes.size(), 1);
+
+    //关闭单独的提示框，汇总框中最早的通知补上
+    boxes.first()->done(QMessageBox::Ok);
+    queue.flush();
+    QCOMPARE(queue.visibleCount(), 1);
+    QCOMPARE(queue.statistics().promoted, qint64(1));
+    QCOMPARE(queue.statistics().boxesShown, qint64(2));
+    boxes = notificationBoxes();
+    QCOMPARE(boxes.size(), 1);
+    QLabel *pLabel = boxes.first()->findChild<QLabel *>("messageTextLabel");
+    QVERIFY(pLabel);
+    QVERIFY2(pLabel->text().startsWith("second %1\n"), qPrintable(pLabel->text()));
+
+    //汇总框中只剩一条，再关闭一次后汇总框也关闭
+    notificationBoxes().first()->done(QMessageBox::Ok);
+    queue.flush();
+    QCOMPARE(queue.statistics().promoted, qint64(2));
+    QCOMPARE(queue.pendingCount(), 1);
+    foreach(QWidget *widget, QApplication::topLevelWidgets()) {
+        QVERIFY(!widget->isVisible() || !widget->findChild<QPlainTextEdit *>());
+    }
+
+    queue.clear();
+}
+
+void tst_MessageBox::hugeTextFirstPaint_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("1KB") << 1024;
+    QTest::newRow("100KB") << 100 * 1024;
+    QTest::newRow("1MB") << 1024 * 1024;
+    QTest::newRow("8MB") << 8 * 1024 * 1024;
+}
+
+void tst_MessageBox::hugeTextFirstPaint()
+{
+    QFETCH(int, size);
+    const QString text = stackTrace(size);
+
+    FirstPaintWatcher watcher;
+    qApp->installEventFilter(&watcher);
+    QFuture<QMessageBox::StandardButton> future = FramelessMessageBox::showAsync(nullptr, "Error", text,
+            QMessageBox::Ok, FramelessMessageBox::MSG_ERROR);
+    QTRY_VERIFY(watcher.nsecs() >= 0);
+    qApp->removeEventFilter(&watcher);
+
+    //只测量摘要，宽度有上限
+    FramelessMessageBox *box = activeMessageBox();
+    QVERIFY(box != Q_NULLPTR);
+    QVERIFY(box->width() < 800);
+    QCOMPARE(box->detailedText().isEmpty(), size <= 2000);
+
+    box->reject();
+    QTRY_VERIFY(future.isFinished());
+
+    //从调用showAsync到第一次绘制的耗时
+    QTest::setBenchmarkResult(watcher.nsecs() / 1e6, QTest::WalltimeMilliseconds);
+}
+
+void tst_MessageBox::detailLoadsLazily()
+{
+    const QString text = stackTrace(4 * 1024 * 1024);
+    FramelessMessageBox box(nullptr, "Error", text);
+    QCOMPARE(box.detailedText(), text);
+    //没有展开之前不创建详细信息控件
+    QVERIFY(box.findChild<QPlainTextEdit *>() == Q_NULLPTR);
+
+    QPushButton *detailButton = box.findChild<QPushButton *>("pDetailButton");
+    QVERIFY(detailButton != Q_NULLPTR);
+    box.show();
+    detailButton->click();
+
+    QPlainTextEdit *view = box.findChild<QPlainTextEdit *>("detailTextView");
+    QVERIFY(view != Q_NULLPTR);
+    //展开后分段加载，最终内容完整
+    QTRY_COMPARE_WITH_TIMEOUT(view->document()->characterCount() - 1, text.size(), 30000);
+}
+
+FRAMELESS_BENCH_MAIN(tst_MessageBox)
+
+#include "tst_messagebox.moc"
@@ -0,0 +1,203 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_mpscqueue.cpp
+ * 无锁队列的多生产者压力测试，以及多个工作线程同时调用FramelessMessageBox::post。
+ * 用qmake CONFIG+=tsan编译后在ThreadSanitizer下运行。
+ *
+ */
+
+#include <QtTest>
+#include <QThread>
+#include <QElapsedTimer>
+#include <algorithm>
+#include "benchmain.h"
+#include "framelesswindow.h"
+#include "messageboxdispatcher.h"
+#include "mpscqueue.h"
+
+namespace {
+
+const int kProducers = 8;
+const int kItemsPerProducer = 200000;
+const int kPostThreads = 4;
+const int kPostsPerThread = 16;
+
+// 高8位是生产者编号，低24位是该生产者的序号
+inline quint32 makeItem(int producer, int seq)
+{
+    return (quint32(producer) << 24) | quint32(seq);
+}
+
+class ProducerThread : public QThread
+{
+public:
+    ProducerThread(MpscQueue<quint32> *queue, int producer)
+        : m_pQueue(queue), m_nProducer(producer) {}
+
+protected:
+    virtual void run()
+    {
+        for(int i = 0; i < kItemsPerProducer; ++i) {
+            m_pQueue->push(makeItem(m_nProducer, i));
+        }
+    }
+
+private:
+    MpscQueue<quint32> *m_pQueue;
+    int m_nProducer;
+};
+
+// 在工作线程中弹出提示框并等待结果
+class PostThread : public QThread
+{
+public:
+    PostThread() : m_nResults(0) {}
+
+    int results() const { return m_nResults; }
+
+protected:
+    virtual void run()
+    {
+        QList<QFuture<QMessageBox::StandardButton> > futures;
+        for(int i = 0; i < kPostsPerThread; ++i) {
+            futures.append(FramelessMessageBox::post("Error", QString("Worker error %1").arg(i)));
+        }
+        for(int i = 0; i < futures.size(); ++i) {
+            futures[i].waitForFinished();
+            m_nResults += !futures.at(i).isCanceled();
+        }
+    }
+
+private:
+    int m_nResults;
+};
+
+} // namespace
+
+class tst_MpscQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void singleThread();
+    void multiProducer();
+    void postFromThreads();
+};
+
+void tst_MpscQueue::singleThread()
+{
+    MpscQueue<int> queue;
+    QVERIFY(queue.isEmpty());
+
+    int value = 0;
+    QVERIFY(!queue.pop(value));
+    for(int i = 0; i < 100; ++i) {
+        queue.push(i);
+    }
+    for(int i = 0; i < 100; ++i) {
+        QVERIFY(queue.pop(value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(queue.isEmpty());
+}
+
+void tst_MpscQueue::multiProducer()
+{
+    MpscQueue<quint32> queue;
+    QList<ProducerThread *> threads;
+    for(int p = 0; p < kProducers; ++p) {
+        threads.append(new ProducerThread(&queue, p));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for(int p = 0; p < kProducers; ++p) {
+        threads.at(p)->start();
+    }
+
+    //主线程是唯一的消费者，和生产者同时运行
+    QVector<int> nextSeq(kProducers, 0);
+    const int total = kProducers * kItemsPerProducer;
+    int received = 0;
+    bool ordered = true;
+    quint32 item = 0;
+    while(received < total) {
+        if(!queue.pop(item)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        const int producer = int(item >> 24);
+        const int seq = int(item & 0xffffff);
+        //同一个生产者的元素保持先后顺序
+        ordered = ordered && producer < kProducers && seq == nextSeq.at(producer);
+        if(producer < kProducers) {
+            nextSeq[producer] = seq + 1;
+        }
+        ++received;
+    }
+    const qint64 nsecs = qMax(Q_INT64_C(1), timer.nsecsElapsed());
+
+    for(int p = 0; p < kProducers; ++p) {
+        QVERIFY(threads.at(p)->wait(10000));
+    }
+    qDeleteAll(threads);
+
+    QVERIFY(ordered);
+    QVERIFY(queue.isEmpty());
+    for(int p = 0; p < kProducers; ++p) {
+        QCOMPARE(nextSeq.at(p), kItemsPerProducer);
+    }
+
+    //按每秒传递的元素个数上报
+    QTest::setBenchmarkResult(qreal(total) * 1e9 / nsecs, QTest::Events);
+}
+
+void tst_MpscQueue::postFromThreads()
+{
+    MessageBoxDispatcher *dispatcher = MessageBoxDispatcher::instance();
+    const qint64 batchesBefore = dispatcher->batchCount();
+    const qint64 drainedBefore = dispatcher->drainedCount();
+
+    //GUI线程定时关闭弹出的提示框，工作线程才能拿到结果
+    QTimer closer;
+    closer.setInterval(20);
+    connect(&closer, &QTimer::timeout, [] {
+        const QWidgetList widgets = QApplication::topLevelWidgets();
+        for(int i = 0; i < widgets.size(); ++i) {
+            FramelessMessageBox *box = qobject_cast<FramelessMessageBox *>(widgets.at(i));
+            if(box && box->isVisible()) {
+                box->reject();
+            }
+        }
+    });
+    closer.start();
+
+    QList<PostThread *> threads;
+    for(int t = 0; t < kPostThreads; ++t) {
+        threads.append(new PostThread);
+        threads.last()->start();
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(std::all_of(threads.constBegin(), threads.constEnd(), [](PostThread *thread) {
+        return thread->isFinished();
+    }), 30000);
+    closer.stop();
+
+    int results = 0;
+    for(int t = 0; t < threads.size(); ++t) {
+        results += threads.at(t)->results();
+    }
+    qDeleteAll(threads);
+
+    const qint64 batches = dispatcher->batchCount() - batchesBefore;
+    const qint64 drained = dispatcher->drainedCount() - drainedBefore;
+
+    QCOMPARE(results, kPostThreads * kPostsPerThread);
+    QCOMPARE(drained, qint64(kPostThreads * kPostsPerThread));
+    QVERIFY(batches <= drained);
+}
+
+FRAMELESS_BENCH_MAIN(tst_MpscQueue)
+
+#include "tst_mpscqueue.moc"
@@ -0,0 +1,121 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_shadowgenerator.cpp
+ * 程序化阴影与PNG阴影的生成耗时对比，各SIMD实现与标量实现的结果一致。
+ *
+ */
+
+#include <QtTest>
+#include <QPixmap>
+#include "benchmain.h"
+#include "shadowgenerator.h"
+#include "shadowtilecache.h"
+
+namespace {
+
+const ShadowGenerator::BlurKernel kKernels[] = {
+    ShadowGenerator::ScalarKernel, ShadowGenerator::Sse2Kernel, ShadowGenerator::Avx2Kernel
+};
+
+// 数据行按实现命名，当前CPU不支持的实现不加入
+void addKernelRows(const QList<int> &radii)
+{
+    QTest::addColumn<int>("kernel");
+    QTest::addColumn<int>("radius");
+
+    for(const ShadowGenerator::BlurKernel kernel : kKernels) {
+        if(!ShadowGenerator::hasKernel(kernel)) {
+            continue;
+        }
+        foreach(int radius, radii) {
+            QTest::newRow(QString("%1-r%2").arg(ShadowGenerator::kernelName(kernel)).arg(radius).toLatin1())
+                    << int(kernel) << radius;
+        }
+    }
+}
+
+// 宽度不是16的倍数，SIMD实现的尾部也走到
+QImage noiseImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    quint32 seed = 12345;
+    for(int y = 0; y < image.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for(int x = 0; x < image.width(); ++x) {
+            seed = seed * 1103515245u + 12345u;
+            const int a = int(seed >> 24);
+            line[x] = qPremultiply(qRgba(int(seed >> 16) & 0xff, int(seed >> 8) & 0xff, int(seed) & 0xff, a));
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+class tst_ShadowGenerator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void kernelMatchesScalar_data();
+    void kernelMatchesScalar();
+
+    void pngShadow();
+    void proceduralShadow_data();
+    void proceduralShadow();
+};
+
+void tst_ShadowGenerator::kernelMatchesScalar_data()
+{
+    addKernelRows(QList<int>() << 1 << 4 << 13 << 64);
+}
+
+void tst_ShadowGenerator::kernelMatchesScalar()
+{
+    QFETCH(int, kernel);
+    QFETCH(int, radius);
+
+    //阴影和任意图片的模糊结果都必须与标量实现逐位相同
+    const QColor color(30, 60, 90, 80);
+    QCOMPARE(ShadowGenerator::generate(radius, color, 3, ShadowGenerator::BlurKernel(kernel)),
+             ShadowGenerator::generate(radius, color, 3, ShadowGenerator::ScalarKernel));
+
+    QImage image = noiseImage(QSize(37, 29));
+    QImage scalar = image;
+    ShadowGenerator::gaussianBlur(image, radius / 3.0 + 0.5, true, true, ShadowGenerator::BlurKernel(kernel));
+    ShadowGenerator::gaussianBlur(scalar, radius / 3.0 + 0.5, true, true, ShadowGenerator::ScalarKernel);
+    QCOMPARE(image, scalar);
+}
+
+void tst_ShadowGenerator::pngShadow()
+{
+    //解码PNG并切片，不经过QPixmapCache
+    QBENCHMARK {
+        QImage image(":/images/background/client-shadow.png");
+        ShadowTiles tiles(QPixmap::fromImage(image), QMargins(8, 8, 8, 8), 1.0);
+        Q_UNUSED(tiles)
+    }
+}
+
+void tst_ShadowGenerator::proceduralShadow_data()
+{
+    addKernelRows(QList<int>() << 4 << 8 << 16 << 32 << 64);
+}
+
+void tst_ShadowGenerator::proceduralShadow()
+{
+    QFETCH(int, kernel);
+    QFETCH(int, radius);
+
+    const QColor color(0, 0, 0, 80);
+    QBENCHMARK {
+        QImage image = ShadowGenerator::generate(radius, color, 0, ShadowGenerator::BlurKernel(kernel));
+        ShadowTiles tiles(QPixmap::fromImage(image), QMargins(radius, radius, radius, radius), 1.0);
+        Q_UNUSED(tiles)
+    }
+}
+
+FRAMELESS_BENCH_MAIN(tst_ShadowGenerator)
+
+#include "tst_shadowgenerator.moc"
@@ -0,0 +1,306 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_theme.cpp
+ * 提示框使用setStyleSheetFile(样式表引擎)与setTheme(ThemeEngine编译的主题)时，创建、切换主题的耗时对比，
+ * 以及两种方式绘制结果的比较。
+ *
+ */
+
+#include <QtTest>
+#include <QImage>
+#include <QLabel>
+#include "benchmain.h"
+#include "framelesswindow.h"
+#include "statebutton.h"
+#include "themeengine.h"
+
+namespace {
+
+const int kWindowCount = 50;
+const char kWhiteTheme[] = ":/style/style_white.qss";
+const char kBlackTheme[] = ":/style/style_black.qss";
+
+void setWindowTheme(FramelessMessageBox *box, bool compiled, const QString &file)
+{
+    if(compiled) {
+        box->setTheme(file);
+    } else {
+        box->setStyleSheetFile(file);
+    }
+}
+
+// setTheme把顶层窗口的背景和边框画在客户区，样式表引擎画的顶层背景被WidgetShadow的客户区盖住，
+// 参照窗口按主题中匹配顶层窗口的规则设置同样的客户区
+void setClientRules(QWidget *window, const QString &file)
+{
+    QSharedPointer<const Theme> theme = ThemeEngine::theme(file);
+    QColor background, borderColor;
+    int borderWidth = 0;
+    foreach(const ThemeRule &rule, theme->rules()) {
+        if(!rule.pseudo.isEmpty() || !rule.matches(window)) {
+            continue;
+        }
+        if(rule.background.isValid()) background = rule.background;
+        if(rule.hasBorder()) {
+            borderColor = rule.borderColor;
+            borderWidth = rule.borderWidth;
+        }
+    }
+    window->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBackground),
+                        background.isValid() ? QVariant(background) : QVariant());
+    window->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderColor),
+                        borderColor.isValid() ? QVariant(borderColor) : QVariant());
+    window->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth), borderWidth);
+}
+
+QColor clientColor(QWidget *window, ThemeEngine::ClientProperty property)
+{
+    return qvariant_cast<QColor>(window->property(ThemeEngine::clientProperty(property)));
+}
+
+QImage renderImage(QWidget *widget)
+{
+    QImage image(widget->size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    widget->render(&image);
+    return image;
+}
+
+// 任一通道相差超过tolerance的像素数
+int differentPixels(const QImage &a, const QImage &b, int tolerance)
+{
+    int count = 0;
+    for(int y = 0; y < a.height(); ++y) {
+        const QRgb *la = reinterpret_cast<const QRgb *>(a.constScanLine(y));
+        const QRgb *lb = reinterpret_cast<const QRgb *>(b.constScanLine(y));
+        for(int x = 0; x < a.width(); ++x) {
+            if(qAbs(qRed(la[x]) - qRed(lb[x])) > tolerance
+                    || qAbs(qGreen(la[x]) - qGreen(lb[x])) > tolerance
+                    || qAbs(qBlue(la[x]) - qBlue(lb[x])) > tolerance
+                    || qAbs(qAlpha(la[x]) - qAlpha(lb[x])) > tolerance) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+class tst_Theme : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void createWindows_data();
+    void createWindows();
+    void switchTheme_data();
+    void switchTheme();
+    void renderMatchesStyleSheet_data();
+    void renderMatchesStyleSheet();
+    void parsedOnce();
+    void complexSelectorMatchesSubject();
+    void specificityBeatsFileOrder();
+    void cleanup();
+};
+
+void tst_Theme::createWindows_data()
+{
+    QTest::addColumn<bool>("compiled");
+    QTest::addColumn<bool>("native");
+
+    QTest::newRow("qss") << false << false;
+    QTest::newRow("compiled") << true << false;
+    QTest::newRow("qss-native") << false << true;
+    QTest::newRow("compiled-native") << true << true;
+}
+
+void tst_Theme::createWindows()
+{
+    QFETCH(bool, compiled);
+    QFETCH(bool, native);
+
+    StateButton::setNativeRendering(native);
+    QImage image(400, 200, QImage::Format_ARGB32_Premultiplied);
+
+    //创建后设置主题并绘制一次，包括样式解析(polish)、布局和绘制
+    QBENCHMARK {
+        for(int i = 0; i < kWindowCount; ++i) {
+            FramelessMessageBox box(nullptr, "Tip", "Benchmark message");
+            setWindowTheme(&box, compiled, kWhiteTheme);
+            box.render(&image);
+        }
+    }
+}
+
+void tst_Theme::switchTheme_data()
+{
+    createWindows_data();
+}
+
+void tst_Theme::switchTheme()
+{
+    QFETCH(bool, compiled);
+    QFETCH(bool, native);
+
+    StateButton::setNativeRendering(native);
+    QImage image(400, 200, QImage::Format_ARGB32_Premultiplied);
+    QList<FramelessMessageBox *> boxes;
+    for(int i = 0; i < kWindowCount; ++i) {
+        FramelessMessageBox *box = new FramelessMessageBox(nullptr, "Tip", "Benchmark message");
+        setWindowTheme(box, compiled, kWhiteTheme);
+        box->render(&image);
+        boxes.append(box);
+    }
+
+    //所有窗口在两个主题之间切换，重新polish后各绘制一次
+    bool black = false;
+    QBENCHMARK {
+        black = !black;
+        foreach(FramelessMessageBox *box, boxes) {
+            setWindowTheme(box, compiled, black ? kBlackTheme : kWhiteTheme);
+            box->render(&image);
+        }
+    }
+
+    qDeleteAll(boxes);
+}
+
+void tst_Theme::renderMatchesStyleSheet_data()
+{
+    QTest::addColumn<QString>("file");
+    QTest::addColumn<bool>("native");
+
+    QTest::newRow("white") << QString(kWhiteTheme) << false;
+    QTest::newRow("black") << QString(kBlackTheme) << false;
+    QTest::newRow("white-native") << QString(kWhiteTheme) << true;
+    QTest::newRow("black-native") << QString(kBlackTheme) << true;
+}
+
+void tst_Theme::renderMatchesStyleSheet()
+{
+    QFETCH(QString, file);
+    QFETCH(bool, native);
+
+    StateButton::setNativeRendering(native);
+
+    FramelessMessageBox qss(nullptr, "Tip", "Benchmark message");
+    qss.setStyleSheetFile(file);
+    setClientRules(&qss, file);
+    FramelessMessageBox compiled(nullptr, "Tip", "Benchmark message");
+    compiled.setTheme(file);
+
+    const QImage expected = renderImage(&qss);
+    const QImage actual = renderImage(&compiled);
+    QCOMPARE(actual.size(), expected.size());
+
+    //两条路径画同样的内容，只允许文字抗锯齿等极少量差异
+    const int different = differentPixels(expected, actual, 8);
+    QVERIFY2(different <= expected.width() * expected.height() / 200,
+             qPrintable(QString("%1 of %2 pixels differ").arg(different).arg(expected.width() * expected.height())));
+}
+
+void tst_Theme::parsedOnce()
+{
+    ThemeEngine::clear();
+    ThemeEngine::resetStatistics();
+    StateButton::setNativeRendering(true);
+
+    QList<FramelessMessageBox *> boxes;
+    for(int i = 0; i < kWindowCount; ++i) {
+        FramelessMessageBox *box = new FramelessMessageBox(nullptr, "Tip", "Benchmark message");
+        box->setTheme(kWhiteTheme);
+        boxes.append(box);
+    }
+
+    const ThemeStatistics statistics = ThemeEngine::statistics();
+    QCOMPARE(statistics.parsedFiles, 1);
+    QCOMPARE(statistics.cacheHits, kWindowCount - 1);
+    QVERIFY(statistics.themedWidgets > 0);
+
+    //原生绘制时所有规则都能映射，顶层窗口的背景和边框画在客户区，不需要样式表
+    QCOMPARE(statistics.residualWindows, qint64(0));
+    foreach(FramelessMessageBox *box, boxes) {
+        QVERIFY(box->styleSheet().isEmpty());
+        QCOMPARE(clientColor(box, ThemeEngine::ClientBackground), QColor("white"));
+        QCOMPARE(clientColor(box, ThemeEngine::ClientBorderColor), QColor("green"));
+        QCOMPARE(box->property(ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth)).toInt(), 1);
+    }
+
+    //同一个主题再次应用时保留窗口的样式表
+    const QString styleSheet = boxes.first()->styleSheet();
+    boxes.first()->setTheme(kWhiteTheme);
+    QCOMPARE(boxes.first()->styleSheet(), styleSheet);
+
+    //非原生绘制的按钮用不到hoverColor，状态背景也交给样式表引擎
+    StateButton::setNativeRendering(false);
+    FramelessMessageBox box(nullptr, "Tip", "Benchmark message");
+    box.setTheme(kWhiteTheme);
+    QVERIFY(box.styleSheet().contains("#minimizeButton:hover"));
+    QVERIFY(box.styleSheet().contains("#closeButton:pressed"));
+    QVERIFY(!box.styleSheet().contains("#framelessMessagBox"));
+
+    //改用样式表文件时恢复setClientColor设置的客户区
+    box.setStyleSheetFile(kWhiteTheme);
+    QVERIFY(!clientColor(&box, ThemeEngine::ClientBackground).isValid());
+    QVERIFY(!clientColor(&box, ThemeEngine::ClientBorderColor).isValid());
+
+    QSharedPointer<const Theme> black = ThemeEngine::theme(kBlackTheme);
+    QVERIFY(black);
+    QCOMPARE(black->residualRuleCount(), 0);
+
+    qDeleteAll(boxes);
+}
+
+void tst_Theme::complexSelectorMatchesSubject()
+{
+    QSharedPointer<const Theme> theme = ThemeEngine::fromStyleSheet(
+        "QDialog QLabel#missingLabel { color: red; }\n"
+        "QDialog > QPushButton#pOkButton:hover { background: red; }\n");
+    QCOMPARE(theme->residualRuleCount(), 2);
+
+    //只有最右边的部分匹配到控件的规则才设置为样式表
+    FramelessMessageBox box(nullptr, "Tip", "Benchmark message");
+    ThemeEngine::apply(&box, theme);
+    QVERIFY(box.styleSheet().contains("pOkButton"));
+    QVERIFY(!box.styleSheet().contains("missingLabel"));
+
+    //没有控件匹配时不启用样式表引擎
+    QWidget window;
+    ThemeEngine::apply(&window, theme);
+    QVERIFY(window.styleSheet().isEmpty());
+}
+
+void tst_Theme::specificityBeatsFileOrder()
+{
+    QSharedPointer<const Theme> theme = ThemeEngine::fromStyleSheet(
+        "QLabel#messageTextLabel { color: red; }\n"
+        "#messageTextLabel { font-size: 12px; }\n"
+        "QLabel { color: blue; font-size: 20px; }\n"
+        "QLabel { color: green; }\n");
+
+    FramelessMessageBox box(nullptr, "Tip", "Benchmark message");
+    ThemeEngine::apply(&box, theme);
+    QLabel *text = box.findChild<QLabel *>("messageTextLabel");
+    QLabel *icon = box.findChild<QLabel *>("m_pIconLabel");
+    QVERIFY(text);
+    QVERIFY(icon);
+
+    //#名称比类型优先，与在文件中的先后无关
+    QCOMPARE(text->palette().color(QPalette::WindowText), QColor(Qt::red));
+    QCOMPARE(text->font().pixelSize(), 12);
+    //优先级相同时后面的覆盖前面的
+    QCOMPARE(icon->palette().color(QPalette::WindowText), QColor(Qt::green));
+    QCOMPARE(icon->font().pixelSize(), 20);
+}
+
+void tst_Theme::cleanup()
+{
+    StateButton::setNativeRendering(false);
+    ThemeEngine::resetStatistics();
+}
+
+FRAMELESS_BENCH_MAIN(tst_Theme)
+
+#include "tst_theme.moc"
@@ -0,0 +1,14 @@
+TEMPLATE = app
+
+TARGET = tst_titlebar
+
+include(../../libframelesswindow/libframelesswindow.pri)
+include(../common/benchmain.pri)
+
+QT += widgets testlib
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    tst_titlebar.cpp
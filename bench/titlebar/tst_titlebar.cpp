@@ -0,0 +1,89 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库/性能测试
+ *
+ * tst_titlebar.cpp
+ * 创建1000个标题栏并各绘制一次：按钮使用样式表、原生绘制与单控件轻量标题栏的耗时对比。
+ *
+ */
+
+#include <QtTest>
+#include <QFile>
+#include <QImage>
+#include "benchmain.h"
+#include "titlebar.h"
+#include "statebutton.h"
+
+namespace {
+
+const int kTitleBarCount = 1000;
+
+QString themeStyleSheet()
+{
+    QFile file(":/style/style_white.qss");
+    if(!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+} // namespace
+
+class tst_TitleBar : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void createTitleBars_data();
+    void createTitleBars();
+    void cleanup();
+};
+
+void tst_TitleBar::createTitleBars_data()
+{
+    QTest::addColumn<bool>("native");
+    QTest::addColumn<bool>("appStyleSheet");
+    QTest::addColumn<int>("type");
+
+    const int standard = AbstractTitleBar::kStandardTitleBar;
+    const int lite = AbstractTitleBar::kLiteTitleBar;
+    QTest::newRow("stylesheet") << false << false << standard;
+    QTest::newRow("native") << true << false << standard;
+    QTest::newRow("lite") << false << false << lite;
+    QTest::newRow("stylesheet-theme") << false << true << standard;
+    QTest::newRow("native-theme") << true << true << standard;
+    QTest::newRow("lite-theme") << false << true << lite;
+}
+
+void tst_TitleBar::createTitleBars()
+{
+    QFETCH(bool, native);
+    QFETCH(bool, appStyleSheet);
+    QFETCH(int, type);
+
+    StateButton::setNativeRendering(native);
+    AbstractTitleBar::setDefaultType(AbstractTitleBar::Type(type));
+    qApp->setStyleSheet(appStyleSheet ? themeStyleSheet() : QString());
+
+    QImage image(800, 30, QImage::Format_ARGB32_Premultiplied);
+
+    //创建后绘制一次，包括样式解析(polish)、布局和按钮绘制
+    QBENCHMARK {
+        QWidget host;
+        for(int i = 0; i < kTitleBarCount; ++i) {
+            AbstractTitleBar *pTitleBar = AbstractTitleBar::create(&host);
+            pTitleBar->resize(800, 30);
+            pTitleBar->render(&image);
+        }
+    }
+}
+
+void tst_TitleBar::cleanup()
+{
+    StateButton::setNativeRendering(false);
+    AbstractTitleBar::setDefaultType(AbstractTitleBar::kStandardTitleBar);
+    qApp->setStyleSheet(QString());
+}
+
+FRAMELESS_BENCH_MAIN(tst_TitleBar)
+
+#include "tst_titlebar.moc"
@@ -1,14 +1,21 @@
 ﻿#include "borderimage.h"
+#include "shadowgenerator.h"
 #include <QTextStream>
+#include <QPixmapCache>
 
 void BorderImage::setPixmap(const QString& url)
 {
     m_pixmapUrl = url;
-    m_pixmap.load(url);
+    //同一张图片在进程内只解码一次，各窗口共享同一份像素数据
+    if(!QPixmapCache::find(url, &m_pixmap)) {
+        m_pixmap.load(url);
+        QPixmapCache::insert(url, m_pixmap);
+    }
 }
 
 void BorderImage::setPixmap(const QPixmap& pixmap)
 {
+    m_pixmapUrl.clear();
     m_pixmap = pixmap;
 }
 
@@ -50,6 +57,16 @@ void BorderImage::setMargin(int left, int top, int right, int bottom)
     m_margin = m;
 }
 
+void BorderImage::setShadow(int radius, const QColor& color, int spread)
+{
+    m_pixmap = ShadowGenerator::pixmap(radius, color, spread);
+    m_pixmapUrl = ShadowGenerator::cacheKey(radius, color, spread);
+
+    const int extent = qMax(0, radius) + qMax(0, spread);
+    setBorder(extent, extent, extent, extent);
+    setMargin(extent, extent, extent, extent);
+}
+
 void BorderImage::load(const QString& pixmap_url, const QString& border, const QString& margin)
 {
     setPixmap(pixmap_url);
@@ -3,6 +3,7 @@
 
 #include <QPixmap>
 #include <QMargins>
+#include <QColor>
 
 class BorderImage
 {
@@ -27,6 +28,9 @@ public:
 
     void load(const QString& pixmap_url, const QString& border, const QString& margin);
 
+    //程序化生成阴影，border和margin都设为 radius + spread
+    void setShadow(int radius, const QColor& color, int spread = 0);
+
 private:
     QMargins m_margin;
     QMargins m_border;
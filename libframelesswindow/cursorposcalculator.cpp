@@ -10,16 +10,16 @@
 #include <QPoint>
 #include <QRect>
 
-int CursorPosCalculator::m_nBorderWidth = 5;
-int CursorPosCalculator::m_nTitleHeight = 30;
-
 CursorPosCalculator::CursorPosCalculator()
+    : m_nBorderWidth(5)
+    , m_nTitleHeight(30)
 {
     reset();
 }
 
 void CursorPosCalculator::reset()
 {
+    m_region = HitTester::Client;
     m_bOnEdges = false;
     m_bOnLeftEdge = false;
     m_bOnRightEdge = false;
@@ -33,29 +33,18 @@ void CursorPosCalculator::reset()
 
 void CursorPosCalculator::recalculate(const QPoint &gMousePos, const QRect &frameRect)
 {
-    int globalMouseX = gMousePos.x();
-    int globalMouseY = gMousePos.y();
-
-    int frameX = frameRect.x();
-    int frameY = frameRect.y();
-
-    int frameWidth = frameRect.width();
-    int frameHeight = frameRect.height();
-
-    m_bOnLeftEdge = (globalMouseX >= frameX &&
-                     globalMouseX <= frameX + m_nBorderWidth);
-    m_bOnRightEdge = (globalMouseX >= frameX + frameWidth - m_nBorderWidth &&
-                      globalMouseX <= frameX + frameWidth);
-    m_bOnTopEdge = (globalMouseY >= frameY &&
-                    globalMouseY <= frameY + m_nBorderWidth);
+    m_region = HitTester::edgeRegion(gMousePos.x() - frameRect.x(), gMousePos.y() - frameRect.y(),
+                                     frameRect.width(), frameRect.height(), m_nBorderWidth);
 
-    m_bOnBottomEdge = (globalMouseY >= frameY + frameHeight - m_nBorderWidth &&
-                       globalMouseY <= frameY + frameHeight);
+    m_bOnTopLeftEdge = (m_region == HitTester::TopLeft);
+    m_bOnBottomLeftEdge = (m_region == HitTester::BottomLeft);
+    m_bOnTopRightEdge = (m_region == HitTester::TopRight);
+    m_bOnBottomRightEdge = (m_region == HitTester::BottomRight);
 
-    m_bOnTopLeftEdge = m_bOnTopEdge && m_bOnLeftEdge;
-    m_bOnBottomLeftEdge = m_bOnBottomEdge && m_bOnLeftEdge;
-    m_bOnTopRightEdge = m_bOnTopEdge && m_bOnRightEdge;
-    m_bOnBottomRightEdge = m_bOnBottomEdge && m_bOnRightEdge;
+    m_bOnLeftEdge = m_bOnTopLeftEdge || m_bOnBottomLeftEdge || m_region == HitTester::Left;
+    m_bOnRightEdge = m_bOnTopRightEdge || m_bOnBottomRightEdge || m_region == HitTester::Right;
+    m_bOnTopEdge = m_bOnTopLeftEdge || m_bOnTopRightEdge || m_region == HitTester::Top;
+    m_bOnBottomEdge = m_bOnBottomLeftEdge || m_bOnBottomRightEdge || m_region == HitTester::Bottom;
 
-    m_bOnEdges = m_bOnLeftEdge || m_bOnRightEdge || m_bOnTopEdge || m_bOnBottomEdge;
+    m_bOnEdges = HitTester::isEdge(m_region);
 }
@@ -8,9 +8,12 @@
 #ifndef CURSORPOSCALCULATOR_H
 #define CURSORPOSCALCULATOR_H
 
+#include "hittester.h"
+
 /**
  * @brief The CursorPosCalculator class
- *  计算鼠标是否位于左、上、右、下、左上角、左下角、右上角、右下角
+ *  计算鼠标是否位于左、上、右、下、左上角、左下角、右上角、右下角。
+ *  边框宽度、标题栏高度属于每个实例，窗体内部使用HitTester
  */
 class QPoint;
 class QRect;
@@ -22,6 +25,8 @@ public:
     void reset();
     void recalculate(const QPoint &gMousePos, const QRect &frameRect);
 
+    HitTester::Region region() const { return m_region; }
+
 public:
     bool m_bOnEdges             : true;
     bool m_bOnLeftEdge          : true;
@@ -33,8 +38,10 @@ public:
     bool m_bOnTopRightEdge      : true;
     bool m_bOnBottomRightEdge   : true;
 
-    static int m_nBorderWidth;
-    static int m_nTitleHeight;
+    HitTester::Region m_region;
+
+    int m_nBorderWidth;
+    int m_nTitleHeight;
 };
 
 #endif // CURSORPOSCALCULATOR_H
@@ -8,7 +8,6 @@
 
 #include "framelesshelper.h"
 #include "framelesshelperprivate.h"
-#include "cursorposcalculator.h"
 #include <QEvent>
 #include <QDebug>
 
@@ -16,10 +15,17 @@ FramelessHelper::FramelessHelper(QObject *parent)
     : QObject(parent)
     , d(new FramelessHelperPrivate())
 {
+    d->q = this;
     d->m_bWidgetMovable = true;
     d->m_bWidgetResizable = true;
     d->m_bRubberBandOnMove = false;
     d->m_bRubberBandOnResize = false;
+    d->m_bResizeCoalescing = false;
+    d->m_nResizeFrameInterval = 0;
+    d->m_nLiveResizeSettleInterval = 150;
+    d->m_nBorderWidth = 5;
+    d->m_nTitleHeight = 30;
+    d->m_pTraceRecorder = nullptr;
 }
 
 FramelessHelper::~FramelessHelper()
@@ -38,8 +44,6 @@ void FramelessHelper::activateOn(QWidget *topLevelWidget)
     if(!d->m_widgetDataHash.contains(topLevelWidget)) {
         WidgetData *data = new WidgetData(d, topLevelWidget);
         d->m_widgetDataHash.insert(topLevelWidget, data);
-
-        topLevelWidget->installEventFilter(this);
     }
 }
 
@@ -47,7 +51,6 @@ void FramelessHelper::removeFrom(QWidget *topLevelWidget)
 {
     WidgetData *data = d->m_widgetDataHash.take(topLevelWidget);
     if(data) {
-        topLevelWidget->removeEventFilter(this);
         delete data;
     }
 }
@@ -83,14 +86,80 @@ void FramelessHelper::setRubberBandOnResize(bool resizable)
 void FramelessHelper::setBorderWidth(uint width)
 {
     if(width > 0) {
-        CursorPosCalculator::m_nBorderWidth = width;
+        d->m_nBorderWidth = width;
+        foreach(WidgetData *data, d->m_widgetDataHash) {
+            data->hitTester()->setBorderWidth(width);
+        }
     }
 }
 
 void FramelessHelper::setTitleHeight(uint height)
 {
     if(height > 0) {
-        CursorPosCalculator::m_nTitleHeight = height;
+        d->m_nTitleHeight = height;
+        foreach(WidgetData *data, d->m_widgetDataHash) {
+            data->hitTester()->setTitleHeight(height);
+        }
+    }
+}
+
+void FramelessHelper::setResizeCoalescing(bool enabled, int frameInterval)
+{
+    d->m_bResizeCoalescing = enabled;
+    d->m_nResizeFrameInterval = qMax(0, frameInterval);
+}
+
+void FramelessHelper::setLiveResizeSettleInterval(int msecs)
+{
+    d->m_nLiveResizeSettleInterval = qMax(0, msecs);
+}
+
+HitTester *FramelessHelper::hitTester(QWidget *topLevelWidget) const
+{
+    WidgetData *data = d->m_widgetDataHash.value(topLevelWidget);
+    return data ? data->hitTester() : nullptr;
+}
+
+FramelessEventStatistics FramelessHelper::eventStatistics(QWidget *topLevelWidget) const
+{
+    if(topLevelWidget) {
+        WidgetData *data = d->m_widgetDataHash.value(topLevelWidget);
+        return data ? data->eventStatistics() : FramelessEventStatistics();
+    }
+
+    FramelessEventStatistics total;
+    foreach(WidgetData *data, d->m_widgetDataHash) {
+        const FramelessEventStatistics statistics = data->eventStatistics();
+        total.handled += statistics.handled;
+        total.deduplicated += statistics.deduplicated;
+        total.cursorChanges += statistics.cursorChanges;
+        total.elapsed = qMax(total.elapsed, statistics.elapsed);
+    }
+    return total;
+}
+
+void FramelessHelper::resetEventStatistics()
+{
+    foreach(WidgetData *data, d->m_widgetDataHash) {
+        data->resetEventStatistics();
+    }
+}
+
+void FramelessHelper::setInputTraceRecorder(InputTraceRecorder *recorder)
+{
+    d->m_pTraceRecorder = recorder;
+}
+
+InputTraceRecorder *FramelessHelper::inputTraceRecorder() const
+{
+    return d->m_pTraceRecorder;
+}
+
+void FramelessHelper::setFrameProfiler(QWidget *topLevelWidget, FrameProfiler *profiler)
+{
+    WidgetData *data = d->m_widgetDataHash.value(topLevelWidget);
+    if(data) {
+        data->setFrameProfiler(profiler);
     }
 }
 
@@ -116,30 +185,25 @@ bool FramelessHelper::rubberBandOnResize() const
 
 uint FramelessHelper::borderWidth() const
 {
-    return CursorPosCalculator::m_nBorderWidth;
+    return d->m_nBorderWidth;
 }
 
 uint FramelessHelper::titleHeight() const
 {
-    return CursorPosCalculator::m_nTitleHeight;
+    return d->m_nTitleHeight;
 }
 
-bool FramelessHelper::eventFilter(QObject *watched, QEvent *event)
+bool FramelessHelper::resizeCoalescing() const
 {
-    switch(event->type()) {
-    case QEvent::MouseMove:
-    case QEvent::HoverMove:
-    case QEvent::MouseButtonPress:
-    case QEvent::MouseButtonRelease:
-    case QEvent::Leave:
-    {
-        WidgetData *data = d->m_widgetDataHash.value(static_cast<QWidget *>(watched));
-        if(data) {
-            data->handleWidgetEvent(event);
-            return true;
-        }
-    }
-    default:
-        return QObject::eventFilter(watched, event);
-    }
+    return d->m_bResizeCoalescing;
+}
+
+int FramelessHelper::resizeFrameInterval() const
+{
+    return d->m_nResizeFrameInterval;
+}
+
+int FramelessHelper::liveResizeSettleInterval() const
+{
+    return d->m_nLiveResizeSettleInterval;
 }
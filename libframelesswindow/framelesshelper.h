@@ -12,9 +12,12 @@
 #include <QObject>
 #include <QHash>
 #include "widgetdata.h"
+#include "hittester.h"
 
 
 class QWdiget;
+class InputTraceRecorder;
+class FrameProfiler;
 class FramelessHelperPrivate;
 class FramelessHelper : public QObject
 {
@@ -86,15 +89,88 @@ public:
      */
     void setTitleHeight(uint height);
 
+    /**
+     * @brief setResizeCoalescing
+     *  设置是否合并缩放。开启后鼠标移动事件被合并，每个帧间隔最多改变一次窗体大小，
+     *  松开鼠标时按最后的位置精确还原最终大小
+     * @param enabled
+     *  bool
+     * @param frameInterval
+     *  int 帧间隔(毫秒)，0表示按窗体所在屏幕的刷新率
+     */
+    void setResizeCoalescing(bool enabled, int frameInterval = 0);
+
+    /**
+     * @brief setLiveResizeSettleInterval
+     *  设置拖动缩放时停顿多久视为缩放暂停，暂停后发出liveResizeChanged(widget, false)
+     * @param msecs
+     *  int 默认150毫秒
+     */
+    void setLiveResizeSettleInterval(int msecs);
+
+    /**
+     * @brief hitTester
+     *  窗体的命中测试，可以注册额外的标题栏区域和标题栏中的非标题栏区域
+     * @param topLevelWidget
+     *  QWidget *
+     * @return
+     *  HitTester * 窗体没有激活时返回nullptr
+     */
+    HitTester *hitTester(QWidget *topLevelWidget) const;
+
+    /**
+     * @brief eventStatistics
+     *  鼠标事件统计，handled为处理的事件数，deduplicated为其中合并掉的重复移动事件数，
+     *  cursorChangesPerSecond()为每秒真正改变鼠标样式的次数
+     * @param topLevelWidget
+     *  QWidget * 为nullptr时返回所有窗体的合计
+     * @return
+     *  FramelessEventStatistics
+     */
+    FramelessEventStatistics eventStatistics(QWidget *topLevelWidget = nullptr) const;
+    void resetEventStatistics();
+
+    /**
+     * @brief setInputTraceRecorder
+     *  设置鼠标事件录制器，窗体收到的鼠标事件在处理前交给它记录，传nullptr停止记录。
+     *  录制器由调用者持有，生命周期需要长于FramelessHelper或者先被移除
+     * @param recorder
+     *  InputTraceRecorder *
+     */
+    void setInputTraceRecorder(InputTraceRecorder *recorder);
+    InputTraceRecorder *inputTraceRecorder() const;
+
+    /**
+     * @brief setFrameProfiler
+     *  拖动移动、缩放窗体的耗时记录到profiler，WidgetShadow把自己的FrameProfiler交给这里
+     * @param topLevelWidget
+     *  QWidget *
+     * @param profiler
+     *  FrameProfiler * 为nullptr时不记录
+     */
+    void setFrameProfiler(QWidget *topLevelWidget, FrameProfiler *profiler);
+
     bool widgetResizable() const;
     bool widgetMoable() const;
     bool rubberBandOnMove() const;
     bool rubberBandOnResize() const;
     uint borderWidth() const;
     uint titleHeight() const;
+    bool resizeCoalescing() const;
+    int resizeFrameInterval() const;
+    int liveResizeSettleInterval() const;
 
-protected:
-    virtual bool eventFilter(QObject *watched, QEvent *event);
+signals:
+    /**
+     * @brief liveResizeChanged
+     *  拖动边框缩放开始(active为true)，或松开鼠标、停顿一段时间(active为false)。
+     *  界面内容可以在缩放过程中降低绘制细节
+     * @param widget
+     *  QWidget * 正在缩放的窗体
+     * @param active
+     *  bool
+     */
+    void liveResizeChanged(QWidget *widget, bool active);
 
 private:
     FramelessHelperPrivate *d;
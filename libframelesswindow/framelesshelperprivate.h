@@ -12,6 +12,9 @@
 #include "widgetdata.h"
 #include <QHash>
 #include <QWidget>
+
+class FramelessHelper;
+class InputTraceRecorder;
 /**
  * @brief The FramelessHelperPrivate class
  *  存储界面对应的数据集合，以及是否可移动、可缩放属性
@@ -19,11 +22,18 @@
 class FramelessHelperPrivate
 {
 public:
+    FramelessHelper *q;
     QHash<QWidget*, WidgetData*> m_widgetDataHash;
     bool m_bWidgetMovable        : true;
     bool m_bWidgetResizable      : true;
     bool m_bRubberBandOnResize   : true;
     bool m_bRubberBandOnMove     : true;
+    bool m_bResizeCoalescing     : true;
+    int  m_nResizeFrameInterval;         // 合并缩放的间隔(毫秒)，0表示按屏幕刷新率
+    int  m_nLiveResizeSettleInterval;    // 拖动缩放停顿多久(毫秒)后视为缩放结束
+    int  m_nBorderWidth;                 // 可缩放的边框宽度
+    int  m_nTitleHeight;                 // 可拖动的标题栏高度
+    InputTraceRecorder *m_pTraceRecorder; // 录制鼠标事件，为空时不录制
 };
 
 #endif // FRAMELESSHELPERPRIVATE_H
@@ -9,6 +9,8 @@
 #include "framelesswindow.h"
 #include "framelesshelper.h"
 #include "titlebar.h"
+#include "messageboxpool.h"
+#include "messageboxdispatcher.h"
 #include <QLayout>
 #include <QLabel>
 #include <QPushButton>
@@ -25,6 +27,26 @@
 #include <QBitmap>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QPointer>
+#include <QTimer>
+#include <QPlainTextEdit>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+
+const int kMaxSummaryChars = 2000;   // 提示信息摘要的最大字符数
+const int kMaxSummaryLines = 20;     // 提示信息摘要的最大行数
+const int kMaxTextWidth = 560;       // 提示信息的最大宽度，超出后换行
+const int kMaxTextHeight = 100000;   // 测量换行后高度时的上限
+const int kDetailWidth = 480;        // 展开详细信息后的最小宽度
+const int kDetailHeight = 240;       // 展开详细信息增加的高度
+const int kDetailChunkSize = 256 * 1024;   // 每次事件循环加载的详细信息字符数
+
+} // namespace
 
 FramelessDialog::FramelessDialog(QWidget *parent)
     : WidgetShadow<QDialog>(parent)
@@ -42,6 +64,15 @@ FramelessMessageBox::FramelessMessageBox(QWidget *parent, const QString &title,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
     : FramelessDialog(parent)
+    , m_pClickedButton(Q_NULLPTR)
+    , m_pDefaultButton(Q_NULLPTR)
+    , m_textFormat(Qt::AutoText)
+    , m_pDetailButton(Q_NULLPTR)
+    , m_pDetailView(Q_NULLPTR)
+    , m_nDetailLoaded(0)
+    , m_nCollapsedHeight(0)
+    , m_bDetailExpanded(false)
+    , m_bAutoDetail(false)
 {
     setObjectName("framelessMessagBox");
     setMinimumVisible(false);
@@ -51,39 +82,13 @@ FramelessMessageBox::FramelessMessageBox(QWidget *parent, const QString &title,
     setMinimumSize(300, 150);
 
     m_pButtonBox = new QDialogButtonBox(this);
-    m_pButtonBox->setStandardButtons(QDialogButtonBox::StandardButtons(int(buttons)));
+    setStandardButtons(buttons);
     setDefaultButton(defaultButton);
 
-    QPushButton *pOkButton = m_pButtonBox->button(QDialogButtonBox::Ok);
-    if(pOkButton != Q_NULLPTR) {
-        pOkButton->setObjectName("pOkButton");
-    }
-
-    QPushButton *pYesButton = m_pButtonBox->button(QDialogButtonBox::Yes);
-    if(pYesButton != Q_NULLPTR) {
-        pYesButton->setObjectName("pYesButton");
-    }
-
-    QPushButton *pNoButton = m_pButtonBox->button(QDialogButtonBox::No);
-    if(pNoButton != Q_NULLPTR) {
-        pNoButton->setObjectName("pNoButton");
-    }
-
-    QPushButton *pCloseButton = m_pButtonBox->button(QDialogButtonBox::Close);
-    if(pCloseButton != Q_NULLPTR) {
-        pCloseButton->setObjectName("pCloseButton");
-    }
-
-    QPushButton *pCancelButton = m_pButtonBox->button(QDialogButtonBox::Cancel);
-    if(pCancelButton != Q_NULLPTR) {
-        pCancelButton->setObjectName("pCancelButton");
-    }
-
     m_pIconLabel = new QLabel(this);
     m_pLabel = new QLabel(this);
 
-    QPixmap pixmap(":/images/msgbox/msg-info-48x48.png");
-    m_pIconLabel->setPixmap(pixmap);
+    m_pIconLabel->setPixmap(IconAtlas::pixmap(IconAtlas::MessageInformation, devicePixelRatioF()));
     m_pIconLabel->setFixedSize(35, 35);
     m_pIconLabel->setScaledContents(true);
     m_pIconLabel->setObjectName("m_pIconLabel");
@@ -91,7 +96,6 @@ FramelessMessageBox::FramelessMessageBox(QWidget *parent, const QString &title,
     m_pLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
     m_pLabel->setObjectName("messageTextLabel");
     m_pLabel->setOpenExternalLinks(true);
-    m_pLabel->setText(text);
 
     m_pGridLayout = new QGridLayout();
     m_pGridLayout->addWidget(m_pIconLabel, 0, 0, 2, 1, Qt::AlignTop);
@@ -103,18 +107,9 @@ FramelessMessageBox::FramelessMessageBox(QWidget *parent, const QString &title,
     m_pGridLayout->setContentsMargins(10, 10, 10, 10);
     m_pFrameLessWindowLayout->addLayout(m_pGridLayout);
 
-    translateUI();
-
     connect(m_pButtonBox, SIGNAL(clicked(QAbstractButton*)), this, SLOT(onButtonClicked(QAbstractButton*)));
 
-    // 计算文字宽度
-    QFont wordfont;
-    wordfont.setFamily(this->font().defaultFamily());
-    wordfont.setPointSize(this->font().pointSize());
-    QFontMetrics fm(wordfont);
-    QRect rect = fm.boundingRect(text);
-
-    resize(rect.width() + 60, 130);
+    applyText(text);
 }
 
 FramelessMessageBox::~FramelessMessageBox()
@@ -154,64 +149,150 @@ void FramelessMessageBox::setTitle(const QString &title)
 
 void FramelessMessageBox::setText(const QString &text)
 {
-    m_pLabel->setText(text);
+    applyText(text);
 }
 
-void FramelessMessageBox::setIcon(const QString &icon)
+void FramelessMessageBox::setTextFormat(Qt::TextFormat format)
 {
-    m_pIconLabel->setPixmap(QPixmap(icon));
+    if(format == m_textFormat) {
+        return;
+    }
+    m_textFormat = format;
+    applyText(m_text);
 }
 
-void FramelessMessageBox::hideInfoIcon()
+Qt::TextFormat FramelessMessageBox::textFormat() const
 {
-    //隐藏Icon
-    m_pIconLabel->setVisible(false);
-    //重新设置文字位置
-    m_pGridLayout->addWidget(m_pLabel, 0, 0, 2, 1, Qt::AlignTop);
+    return m_textFormat;
 }
 
-void FramelessMessageBox::addWidget(QWidget *pWidget)
+void FramelessMessageBox::setDetailedText(const QString &text)
 {
-    m_pLabel->hide();
-    m_pGridLayout->addWidget(pWidget, 0, 1, 2, 1);
+    m_bAutoDetail = false;
+    m_detailText = text;
+    m_nDetailLoaded = 0;
+    if(m_pDetailView) {
+        m_pDetailView->clear();
+    }
+
+    if(text.isEmpty()) {
+        setDetailsExpanded(false);
+        if(m_pDetailButton) {
+            m_pDetailButton->hide();
+        }
+        return;
+    }
+
+    if(!m_pDetailButton) {
+        m_pDetailButton = m_pButtonBox->addButton(tr("Show Details..."), QDialogButtonBox::ActionRole);
+        m_pDetailButton->setObjectName("pDetailButton");
+        m_pDetailButton->setAutoDefault(false);
+    }
+    m_pDetailButton->show();
+    if(m_bDetailExpanded) {
+        loadDetailChunk();
+    }
 }
 
-QMessageBox::StandardButton FramelessMessageBox::showMessageBox(QWidget *parent,
-        const QString &title,
-        const QString &text,
-        QMessageBox::StandardButtons buttons,
-        IconType messageType,
-        QMessageBox::StandardButton defaultButton)
+QString FramelessMessageBox::detailedText() const
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.hideTitleBarIcon();
+    return m_detailText;
+}
+
+void FramelessMessageBox::setIcon(const QString &icon)
+{
+    m_pIconLabel->setPixmap(QPixmap(icon));
+}
+
+void FramelessMessageBox::setIcon(IconAtlas::Icon icon)
+{
+    m_pIconLabel->setPixmap(IconAtlas::pixmap(icon, devicePixelRatioF()));
+}
 
-    switch(messageType) {
+void FramelessMessageBox::setIconType(IconType type)
+{
+    switch(type) {
     case MSG_NOICON:
-        msgBox.hideInfoIcon();
+        hideInfoIcon();
         break;
     case MSG_INFORMATION:
-        msgBox.setIcon(":/images/msgbox/msg-info-48x48.png");
+        setIcon(IconAtlas::MessageInformation);
         break;
     case MSG_WARNNING:
-        msgBox.setIcon(":/images/msgbox/msg-warning-48x48.png");
+        setIcon(IconAtlas::MessageWarning);
         break;
     case MSG_QUESTION:
-        msgBox.setIcon(":/images/msgbox/msg-question-48x48.png");
+        setIcon(IconAtlas::MessageQuestion);
         break;
     case MSG_ERROR:
-        msgBox.setIcon(":/images/msgbox/msg-error-48x48.png");
+        setIcon(IconAtlas::MessageError);
         break;
     case MSG_SUCCESS:
-        msgBox.setIcon(":/images/msgbox/msg-success-48x48.png");
+        setIcon(IconAtlas::MessageSuccess);
         break;
     default:
         break;
     }
+}
 
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+void FramelessMessageBox::hideInfoIcon()
+{
+    //隐藏Icon
+    m_pIconLabel->setVisible(false);
+    //重新设置文字位置，先移出原来的格子，避免同一个控件在布局中出现两次
+    m_pGridLayout->removeWidget(m_pLabel);
+    m_pGridLayout->addWidget(m_pLabel, 0, 0, 2, 1, Qt::AlignTop);
+}
+
+void FramelessMessageBox::addWidget(QWidget *pWidget)
+{
+    m_pLabel->hide();
+    m_pGridLayout->addWidget(pWidget, 0, 1, 2, 1);
+}
+
+namespace {
+
+/**
+ * @brief The AsyncResult struct
+ *  一次异步弹出的结果，提示框关闭或被销毁时完成
+ */
+struct AsyncResult
+{
+    QFutureInterface<QMessageBox::StandardButton> future;
+    FramelessMessageBox::ResultCallback callback;
+    QMetaObject::Connection finishedConnection;
+    QMetaObject::Connection destroyedConnection;
+
+    // 提示框会被复用，只接收这一次的信号
+    void disconnect()
+    {
+        QObject::disconnect(finishedConnection);
+        QObject::disconnect(destroyedConnection);
+    }
+
+    void complete(QMessageBox::StandardButton button)
+    {
+        if(future.isFinished()) {
+            return;
+        }
+        future.reportResult(button);
+        future.reportFinished();
+        if(callback) {
+            callback(button);
+        }
+    }
+};
+
+} // namespace
+
+QMessageBox::StandardButton FramelessMessageBox::showMessageBox(QWidget *parent,
+        const QString &title,
+        const QString &text,
+        QMessageBox::StandardButtons buttons,
+        IconType messageType,
+        QMessageBox::StandardButton defaultButton)
+{
+    return execPooled(parent, title, text, buttons, defaultButton, messageType, false);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showInformation(QWidget *parent,
@@ -220,11 +301,7 @@ QMessageBox::StandardButton FramelessMessageBox::showInformation(QWidget *parent
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-info-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_INFORMATION);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showError(QWidget *parent,
@@ -233,11 +310,7 @@ QMessageBox::StandardButton FramelessMessageBox::showError(QWidget *parent,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-error-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_ERROR);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showSuccess(QWidget *parent,
@@ -246,11 +319,7 @@ QMessageBox::StandardButton FramelessMessageBox::showSuccess(QWidget *parent,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-success-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_SUCCESS);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showQuestion(QWidget *parent,
@@ -259,11 +328,7 @@ QMessageBox::StandardButton FramelessMessageBox::showQuestion(QWidget *parent,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-question-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_QUESTION);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showWarning(QWidget *parent,
@@ -272,11 +337,7 @@ QMessageBox::StandardButton FramelessMessageBox::showWarning(QWidget *parent,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-warning-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_WARNNING);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showCritical(QWidget *parent,
@@ -285,11 +346,7 @@ QMessageBox::StandardButton FramelessMessageBox::showCritical(QWidget *parent,
         QMessageBox::StandardButtons buttons,
         QMessageBox::StandardButton defaultButton)
 {
-    FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-warning-48x48.png");
-    if(msgBox.exec() == -1)
-        return QMessageBox::Cancel;
-    return msgBox.standardButton(msgBox.clickedButton());
+    return execPooled(parent, title, text, buttons, defaultButton, MSG_WARNNING);
 }
 
 QMessageBox::StandardButton FramelessMessageBox::showCheckBoxQuestion(QWidget *parent,
@@ -299,7 +356,7 @@ QMessageBox::StandardButton FramelessMessageBox::showCheckBoxQuestion(QWidget *p
         QMessageBox::StandardButton defaultButton)
 {
     FramelessMessageBox msgBox(parent, title, text, buttons, defaultButton);
-    msgBox.setIcon(":/images/msgbox/msg-question-48x48.png");
+    msgBox.setIcon(IconAtlas::MessageQuestion);
 
     QCheckBox *pCheckBox = new QCheckBox(&msgBox);
     pCheckBox->setText(text);
@@ -314,6 +371,133 @@ QMessageBox::StandardButton FramelessMessageBox::showCheckBoxQuestion(QWidget *p
     return QMessageBox::Cancel;
 }
 
+QFuture<QMessageBox::StandardButton> FramelessMessageBox::post(const QString &title,
+        const QString &text,
+        QMessageBox::StandardButtons buttons,
+        IconType messageType,
+        QMessageBox::StandardButton defaultButton)
+{
+    //还没有QApplication时分发器无法移到GUI线程，它的事件永远不会被处理
+    if(!QCoreApplication::instance()) {
+        qWarning("FramelessMessageBox::post: no QApplication, the request is canceled");
+        return MessageBoxDispatcher::canceledFuture();
+    }
+    return MessageBoxDispatcher::instance()->post(title, text, buttons, messageType, defaultButton);
+}
+
+void FramelessMessageBox::setPoolSize(int size)
+{
+    MessageBoxPool::instance()->setPoolSize(size);
+}
+
+int FramelessMessageBox::poolSize()
+{
+    return MessageBoxPool::instance()->poolSize();
+}
+
+void FramelessMessageBox::setPoolIdleTimeout(int msecs)
+{
+    MessageBoxPool::instance()->setIdleTimeout(msecs);
+}
+
+int FramelessMessageBox::poolIdleTimeout()
+{
+    return MessageBoxPool::instance()->idleTimeout();
+}
+
+void FramelessMessageBox::prewarmPool()
+{
+    MessageBoxPool::instance()->prewarm();
+}
+
+QFuture<QMessageBox::StandardButton> FramelessMessageBox::showAsync(QWidget *parent,
+        const QString &title,
+        const QString &text,
+        QMessageBox::StandardButtons buttons,
+        IconType messageType,
+        QMessageBox::StandardButton defaultButton)
+{
+    return showPooled(parent, title, text, buttons, defaultButton, messageType, false, ResultCallback());
+}
+
+QFuture<QMessageBox::StandardButton> FramelessMessageBox::showAsync(QWidget *parent,
+        const QString &title,
+        const QString &text,
+        const ResultCallback &callback,
+        QMessageBox::StandardButtons buttons,
+        IconType messageType,
+        QMessageBox::StandardButton defaultButton)
+{
+    return showPooled(parent, title, text, buttons, defaultButton, messageType, false, callback);
+}
+
+QFuture<QMessageBox::StandardButton> FramelessMessageBox::showPooled(QWidget *parent,
+        const QString &title,
+        const QString &text,
+        QMessageBox::StandardButtons buttons,
+        QMessageBox::StandardButton defaultButton,
+        IconType messageType,
+        bool titleIcon,
+        const ResultCallback &callback)
+{
+    MessageBoxPool *pPool = MessageBoxPool::instance();
+    FramelessMessageBox *pMsgBox = pPool->acquire(parent, title, text, buttons, defaultButton);
+    if(!titleIcon) {
+        pMsgBox->hideTitleBarIcon();
+    }
+    pMsgBox->setIconType(messageType);
+
+    QSharedPointer<AsyncResult> result(new AsyncResult);
+    result->callback = callback;
+    result->future.reportStarted();
+
+    result->finishedConnection = connect(pMsgBox, &QDialog::finished, [result, pMsgBox](int code) {
+        result->disconnect();
+        const QMessageBox::StandardButton button = (code == -1) ? QMessageBox::Cancel
+                : pMsgBox->standardButton(pMsgBox->clickedButton());
+        //提示框还在发送自己的信号，归还和回调放到下一次事件循环，
+        //回调中再弹出提示框时可以安全复用同一个
+        QPointer<FramelessMessageBox> guard(pMsgBox);
+        QTimer::singleShot(0, MessageBoxPool::instance(), [result, guard, button]() {
+            MessageBoxPool::instance()->release(guard.data());
+            result->complete(button);
+        });
+    });
+    //父窗体销毁时提示框随之删除，不会发出finished
+    result->destroyedConnection = connect(pMsgBox, &QObject::destroyed, [result]() {
+        result->disconnect();
+        result->complete(QMessageBox::Cancel);
+    });
+
+    pMsgBox->setWindowModality(Qt::ApplicationModal);
+    pMsgBox->show();
+    return result->future.future();
+}
+
+QMessageBox::StandardButton FramelessMessageBox::execPooled(QWidget *parent,
+        const QString &title,
+        const QString &text,
+        QMessageBox::StandardButtons buttons,
+        QMessageBox::StandardButton defaultButton,
+        IconType messageType,
+        bool titleIcon)
+{
+    QFuture<QMessageBox::StandardButton> future = showPooled(parent, title, text, buttons, defaultButton,
+            messageType, titleIcon, ResultCallback());
+
+    //同步接口需要等待用户选择，仍然是一个局部事件循环；不想阻塞调用方时使用showAsync
+    if(!future.isFinished()) {
+        QEventLoop loop;
+        QFutureWatcher<QMessageBox::StandardButton> watcher;
+        connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+        watcher.setFuture(future);
+        if(!future.isFinished()) {
+            loop.exec(QEventLoop::DialogExec);
+        }
+    }
+    return future.result();
+}
+
 void FramelessMessageBox::changeEvent(QEvent *event)
 {
     switch(event->type()) {
@@ -328,6 +512,11 @@ void FramelessMessageBox::changeEvent(QEvent *event)
 
 void FramelessMessageBox::onButtonClicked(QAbstractButton *button)
 {
+    if(button != Q_NULLPTR && button == m_pDetailButton) {
+        setDetailsExpanded(!m_bDetailExpanded);
+        return;
+    }
+
     m_pClickedButton = button;
     done(execReturnCode(button));
 }
@@ -349,6 +538,9 @@ void FramelessMessageBox::translateUI()
     QPushButton *pCancelButton = m_pButtonBox->button(QDialogButtonBox::Cancel);
     if(pCancelButton != NULL)
         pCancelButton->setText(tr("Cancel"));
+
+    if(m_pDetailButton != NULL)
+        m_pDetailButton->setText(m_bDetailExpanded ? tr("Hide Details...") : tr("Show Details..."));
 }
 
 int FramelessMessageBox::execReturnCode(QAbstractButton *button)
@@ -356,3 +548,188 @@ int FramelessMessageBox::execReturnCode(QAbstractButton *button)
     int nResult = m_pButtonBox->standardButton(button);
     return nResult;
 }
+
+void FramelessMessageBox::setStandardButtons(QMessageBox::StandardButtons buttons)
+{
+    const QDialogButtonBox::StandardButtons standardButtons(int(buttons));
+    //按钮相同时不重建，复用的提示框大多是同一组按钮
+    if(m_pButtonBox->standardButtons() == standardButtons) {
+        return;
+    }
+    m_pButtonBox->setStandardButtons(standardButtons);
+
+    QPushButton *pOkButton = m_pButtonBox->button(QDialogButtonBox::Ok);
+    if(pOkButton != Q_NULLPTR) {
+        pOkButton->setObjectName("pOkButton");
+    }
+
+    QPushButton *pYesButton = m_pButtonBox->button(QDialogButtonBox::Yes);
+    if(pYesButton != Q_NULLPTR) {
+        pYesButton->setObjectName("pYesButton");
+    }
+
+    QPushButton *pNoButton = m_pButtonBox->button(QDialogButtonBox::No);
+    if(pNoButton != Q_NULLPTR) {
+        pNoButton->setObjectName("pNoButton");
+    }
+
+    QPushButton *pCloseButton = m_pButtonBox->button(QDialogButtonBox::Close);
+    if(pCloseButton != Q_NULLPTR) {
+        pCloseButton->setObjectName("pCloseButton");
+    }
+
+    QPushButton *pCancelButton = m_pButtonBox->button(QDialogButtonBox::Cancel);
+    if(pCancelButton != Q_NULLPTR) {
+        pCancelButton->setObjectName("pCancelButton");
+    }
+
+    translateUI();
+}
+
+void FramelessMessageBox::adjustSizeToText(const QString &text)
+{
+    // 计算文字宽度，只测量有长度上限的摘要
+    QFont wordfont;
+    wordfont.setFamily(this->font().defaultFamily());
+    wordfont.setPointSize(this->font().pointSize());
+    QFontMetrics fm(wordfont);
+    QRect rect = fm.boundingRect(QRect(0, 0, kMaxTextWidth, kMaxTextHeight),
+                                 Qt::AlignLeft | Qt::TextWordWrap, text);
+
+    //超过宽度上限的文字换行显示，不再把窗体撑宽
+    m_pLabel->setWordWrap(rect.width() >= kMaxTextWidth || text.contains(QLatin1Char('\n')));
+    resize(rect.width() + 60, qMax(130, rect.height() + 100));
+}
+
+void FramelessMessageBox::applyText(const QString &text)
+{
+    m_text = text;
+    bool truncated = false;
+    const QString summary = summaryOf(text, &truncated);
+
+    //不是富文本时明确按纯文本显示，不创建富文本文档；截断的文字可能切断标签，也按纯文本显示
+    Qt::TextFormat format = m_textFormat;
+    if(truncated || (format == Qt::AutoText && !Qt::mightBeRichText(summary))) {
+        format = Qt::PlainText;
+    }
+    m_pLabel->setTextFormat(format);
+    m_pLabel->setText(summary);
+
+    if(truncated) {
+        setDetailedText(text);
+        m_bAutoDetail = true;
+    } else if(m_bAutoDetail) {
+        setDetailedText(QString());
+    }
+
+    adjustSizeToText(summary);
+}
+
+void FramelessMessageBox::setDetailsExpanded(bool expanded)
+{
+    if(expanded == m_bDetailExpanded) {
+        return;
+    }
+    m_bDetailExpanded = expanded;
+
+    if(expanded) {
+        if(!m_pDetailView) {
+            m_pDetailView = new QPlainTextEdit(this);
+            m_pDetailView->setObjectName("detailTextView");
+            m_pDetailView->setReadOnly(true);
+            m_pDetailView->setUndoRedoEnabled(false);
+            m_pDetailView->setLineWrapMode(QPlainTextEdit::NoWrap);
+            m_pGridLayout->addWidget(m_pDetailView, m_pGridLayout->rowCount(), 0, 1, m_pGridLayout->columnCount());
+        }
+        m_pDetailView->show();
+        m_nCollapsedHeight = height();
+        resize(qMax(width(), kDetailWidth), height() + kDetailHeight);
+        //第一段在下一次事件循环加载，展开按钮先响应
+        if(m_nDetailLoaded < m_detailText.size()) {
+            QTimer::singleShot(0, this, SLOT(loadDetailChunk()));
+        }
+    } else {
+        if(m_pDetailView) {
+            m_pDetailView->hide();
+        }
+        if(m_nCollapsedHeight > 0) {
+            resize(width(), m_nCollapsedHeight);
+        }
+    }
+
+    if(m_pDetailButton) {
+        m_pDetailButton->setText(expanded ? tr("Hide Details...") : tr("Show Details..."));
+    }
+}
+
+void FramelessMessageBox::loadDetailChunk()
+{
+    if(!m_pDetailView || !m_bDetailExpanded || m_nDetailLoaded >= m_detailText.size()) {
+        return;
+    }
+
+    int size = qMin(kDetailChunkSize, m_detailText.size() - m_nDetailLoaded);
+    //不在代理对中间截断
+    if(m_nDetailLoaded + size < m_detailText.size() && m_detailText.at(m_nDetailLoaded + size - 1).isHighSurrogate()) {
+        --size;
+    }
+
+    QTextCursor cursor(m_pDetailView->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(m_detailText.mid(m_nDetailLoaded, size));
+    m_nDetailLoaded += size;
+
+    if(m_nDetailLoaded < m_detailText.size()) {
+        QTimer::singleShot(0, this, SLOT(loadDetailChunk()));
+    }
+}
+
+QString FramelessMessageBox::summaryOf(const QString &text, bool *truncated)
+{
+    int end = qMin(text.size(), kMaxSummaryChars);
+    int lines = 0;
+    for(int i = 0; i < end; ++i) {
+        if(text.at(i) == QLatin1Char('\n') && ++lines == kMaxSummaryLines) {
+            end = i;
+            break;
+        }
+    }
+
+    *truncated = end < text.size();
+    if(!*truncated) {
+        return text;
+    }
+    return text.left(end) + QStringLiteral("\n...");
+}
+
+void FramelessMessageBox::reconfigure(const QString &title, const QString &text,
+                                      QMessageBox::StandardButtons buttons,
+                                      QMessageBox::StandardButton defaultButton)
+{
+    m_pClickedButton = Q_NULLPTR;
+    m_pDefaultButton = Q_NULLPTR;
+
+    setWindowTitle(title);
+    setStandardButtons(buttons);
+    //保留下来的按钮可能还是上一次的默认按钮
+    QList<QAbstractButton *> buttonList = m_pButtonBox->buttons();
+    for(int i = 0; i < buttonList.size(); ++i) {
+        if(QPushButton *pButton = qobject_cast<QPushButton *>(buttonList.at(i))) {
+            pButton->setDefault(false);
+        }
+    }
+    setDefaultButton(defaultButton);
+
+    //撤销上一次的hideInfoIcon、hideTitleBarIcon
+    m_pIconLabel->setVisible(true);
+    m_pGridLayout->removeWidget(m_pLabel);
+    m_pGridLayout->addWidget(m_pLabel, 0, 1, 2, 1);
+    if(m_pTitleBar) {
+        m_pTitleBar->showTitleIcon();
+    }
+
+    setDetailsExpanded(false);
+    setDetailedText(QString());
+    m_textFormat = Qt::AutoText;
+    applyText(text);
+}
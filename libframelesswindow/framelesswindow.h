@@ -12,6 +12,7 @@
 #include "framelesswindow_global.h"
 #include "borderimage.h"
 #include "widgetshadow.h"
+#include "iconatlas.h"
 #include <QtWidgets>
 #include <QDialog>
 #include <QMessageBox>
@@ -20,6 +21,8 @@
 #include <QPaintEvent>
 #include <QPainter>
 #include <QEventLoop>
+#include <QFuture>
+#include <functional>
 
 typedef WidgetShadow<QWidget> FramelessWindow;
 
@@ -42,6 +45,7 @@ class QGridLayout;
 class QDialogButtonBox;
 class QHBoxLayout;
 class QAbstractButton;
+class QPlainTextEdit;
 /**
  * @brief The FramelessMessageBox class
  *  无边框自定义提示框
@@ -56,6 +60,8 @@ public:
 
     ~FramelessMessageBox();
 
+    typedef std::function<void(QMessageBox::StandardButton)> ResultCallback;
+
     enum IconType {
         MSG_NOICON = 0,  // 无图标
         MSG_INFORMATION, // 提示信息
@@ -86,12 +92,40 @@ public:
      * @param text
      */
     void setText(const QString &text);
+    /**
+     * @brief setTextFormat
+     * @note 提示信息的格式，默认Qt::AutoText。不是富文本时走纯文本的快速路径。
+     *  已经显示的提示信息按新的格式重新显示
+     * @param format
+     */
+    void setTextFormat(Qt::TextFormat format);
+    Qt::TextFormat textFormat() const;
+    /**
+     * @brief setDetailedText
+     * @note 设置详细信息，按钮栏出现"显示详细信息"按钮，展开后才创建并分段加载文字。
+     *  提示信息超过摘要的长度或行数时，自动截取摘要、完整文字放入详细信息
+     * @param text
+     */
+    void setDetailedText(const QString &text);
+    QString detailedText() const;
     /**
      * @brief setIcon
      * @note 设置窗体图标
      * @param icon
      */
     void setIcon(const QString &icon);
+    /**
+     * @brief setIcon
+     * @note 设置图集中的图标，不解码PNG
+     * @param icon
+     */
+    void setIcon(IconAtlas::Icon icon);
+    /**
+     * @brief setIconType
+     * @note 按提示类型设置图标，MSG_NOICON隐藏图标
+     * @param type
+     */
+    void setIconType(IconType type);
 
     /**
      * @brief hideInfoIcon
@@ -133,6 +167,65 @@ public:
             const QString &text, QMessageBox::StandardButtons buttons,
             QMessageBox::StandardButton defaultButton);
 
+    /**
+     * @brief showAsync
+     * @note 弹出提示框后立即返回，不进入嵌套事件循环，GUI线程照常处理定时器和网络等事件。
+     *  提示框是应用程序模态的。点击的按钮通过QFuture返回(可以用QFutureWatcher接收finished信号)，
+     *  按Esc关闭时为NoButton，父窗体在提示框关闭前销毁时为Cancel
+     * @return
+     */
+    static QFuture<QMessageBox::StandardButton> showAsync(QWidget *parent, const QString &title,
+            const QString &text, QMessageBox::StandardButtons buttons = QMessageBox::Ok,
+            IconType messageType = MSG_NOICON,
+            QMessageBox::StandardButton defaultButton = QMessageBox::NoButton);
+
+    /**
+     * @brief showAsync
+     * @note 同上，提示框关闭后在GUI线程调用callback
+     */
+    static QFuture<QMessageBox::StandardButton> showAsync(QWidget *parent, const QString &title,
+            const QString &text, const ResultCallback &callback,
+            QMessageBox::StandardButtons buttons = QMessageBox::Ok,
+            IconType messageType = MSG_NOICON,
+            QMessageBox::StandardButton defaultButton = QMessageBox::NoButton);
+
+    /**
+     * @brief post
+     * @note 线程安全，任意线程都可以调用。请求放入无锁队列后立即返回，
+     *  GUI线程在下一次事件循环中成批取出并用showAsync弹出(没有父窗体)。
+     *  工作线程可以对返回的QFuture调用waitForFinished等待结果，GUI线程不要等待。
+     *  还没有QApplication时、或者程序退出时提示框仍未关闭，QFuture按取消结束：
+     *  isCanceled()为true，没有result()，取结果前先检查
+     * @return
+     */
+    static QFuture<QMessageBox::StandardButton> post(const QString &title, const QString &text,
+            QMessageBox::StandardButtons buttons = QMessageBox::Ok,
+            IconType messageType = MSG_ERROR,
+            QMessageBox::StandardButton defaultButton = QMessageBox::NoButton);
+
+    /**
+     * @brief setPoolSize
+     * @note 静态show*函数复用的隐藏提示框个数，默认2，0表示每次新建。
+     *  改变后在事件循环中预先创建
+     * @param size
+     */
+    static void setPoolSize(int size);
+    static int poolSize();
+
+    /**
+     * @brief setPoolIdleTimeout
+     * @note 池中提示框空闲多久(毫秒)后释放，始终保留一个，默认60秒，0表示不释放
+     * @param msecs
+     */
+    static void setPoolIdleTimeout(int msecs);
+    static int poolIdleTimeout();
+
+    /**
+     * @brief prewarmPool
+     * @note 立即把池填满，程序启动后调用，第一次弹出提示框时就不需要构造
+     */
+    static void prewarmPool();
+
 
 protected:
     /**
@@ -144,10 +237,34 @@ protected:
 
 private slots:
     void onButtonClicked(QAbstractButton *button);
+    // 展开后每次事件循环追加一段详细信息
+    void loadDetailChunk();
 
 private:
+    friend class MessageBoxPool;
+
     void translateUI();
     int execReturnCode(QAbstractButton *button);
+    void setStandardButtons(QMessageBox::StandardButtons buttons);
+    // 按文字宽度调整窗体大小，宽度有上限，超出后换行
+    void adjustSizeToText(const QString &text);
+    // 截取摘要并设置提示信息，过长时完整文字放入详细信息
+    void applyText(const QString &text);
+    void setDetailsExpanded(bool expanded);
+    // 摘要最多kMaxSummaryLines行、kMaxSummaryChars个字符，只扫描这一部分
+    static QString summaryOf(const QString &text, bool *truncated);
+    // 池中取出后重新设置标题、文字、按钮，并撤销hideInfoIcon等修改
+    void reconfigure(const QString &title, const QString &text,
+                     QMessageBox::StandardButtons buttons, QMessageBox::StandardButton defaultButton);
+    // 从池中取出提示框并显示，不等待关闭
+    static QFuture<QMessageBox::StandardButton> showPooled(QWidget *parent, const QString &title,
+            const QString &text, QMessageBox::StandardButtons buttons,
+            QMessageBox::StandardButton defaultButton, IconType messageType, bool titleIcon,
+            const ResultCallback &callback);
+    // 同步版本，在局部事件循环中等待showPooled的结果
+    static QMessageBox::StandardButton execPooled(QWidget *parent, const QString &title,
+            const QString &text, QMessageBox::StandardButtons buttons,
+            QMessageBox::StandardButton defaultButton, IconType messageType, bool titleIcon = true);
 
 private:
     QLabel *m_pIconLabel;
@@ -157,6 +274,15 @@ private:
     QAbstractButton *m_pClickedButton;
     QAbstractButton *m_pDefaultButton;
     QHBoxLayout *m_pLayout;
+    Qt::TextFormat m_textFormat;
+    QString m_text;                    //完整的提示信息，改变格式时重新显示
+    QPushButton *m_pDetailButton;      //显示/隐藏详细信息，有详细信息时才创建
+    QPlainTextEdit *m_pDetailView;     //第一次展开时创建
+    QString m_detailText;
+    int m_nDetailLoaded;               //已经加载到m_pDetailView的字符数
+    int m_nCollapsedHeight;            //展开前的高度
+    bool m_bDetailExpanded;
+    bool m_bAutoDetail;                //详细信息是否由过长的提示信息自动生成
 };
 
 #endif // FRAMELESSWINDOW_H
@@ -0,0 +1,305 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * frameprofiler.cpp
+ * 帧耗时直方图和Chrome trace导出。
+ *
+ */
+
+#include "frameprofiler.h"
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QtAlgorithms>
+
+Q_LOGGING_CATEGORY(lcFramelessFrame, "frameless.frame", QtInfoMsg)
+
+namespace {
+
+const int kSubBucketBits = 4;
+const int kSubBucketCount = 1 << kSubBucketBits;
+const int kMaxValueBits = 44; // 约4.9小时，更大的值按最大值统计
+const int kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+const int kDefaultTraceCapacity = 4096;
+
+bool s_bEnabled = false;
+
+struct ProcessClock
+{
+    ProcessClock() { timer.start(); }
+    QElapsedTimer timer;
+};
+Q_GLOBAL_STATIC(ProcessClock, s_processClock)
+
+// 一个窗体的trace事件，tid区分窗体
+void appendTraceEvents(QJsonArray *events, const FrameProfiler *profiler, int tid, const QJsonArray &traceEvents)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonObject args;
+    args.insert("name", profiler->name().isEmpty() ? QString("window %1").arg(tid) : profiler->name());
+    QJsonObject meta;
+    meta.insert("name", "thread_name");
+    meta.insert("ph", "M");
+    meta.insert("pid", pid);
+    meta.insert("tid", tid);
+    meta.insert("args", args);
+    events->append(meta);
+
+    for(int i = 0; i < traceEvents.size(); ++i) {
+        QJsonObject event = traceEvents.at(i).toObject();
+        event.insert("pid", pid);
+        event.insert("tid", tid);
+        events->append(event);
+    }
+}
+
+QByteArray toChromeTrace(const QJsonArray &events)
+{
+    QJsonObject root;
+    root.insert("traceEvents", events);
+    root.insert("displayTimeUnit", "ms");
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : m_nCount(0)
+    , m_nTotal(0)
+    , m_nMin(0)
+    , m_nMax(0)
+{
+}
+
+int LatencyHistogram::bucketIndex(qint64 value)
+{
+    if(value <= 0) {
+        return 0;
+    }
+    value = qMin(value, (Q_INT64_C(1) << kMaxValueBits) - 1);
+
+    const int msb = 63 - qCountLeadingZeroBits(quint64(value));
+    if(msb < kSubBucketBits) {
+        return int(value);
+    }
+    //最高位以下保留kSubBucketBits位
+    const int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBucketCount + int((value >> shift) - kSubBucketCount);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if(index < kSubBucketCount) {
+        return index;
+    }
+    const int shift = index / kSubBucketCount - 1;
+    const qint64 low = qint64(kSubBucketCount + index % kSubBucketCount) << shift;
+    return low + (Q_INT64_C(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 nsecs)
+{
+    nsecs = qMax(Q_INT64_C(0), nsecs);
+    if(m_counts.isEmpty()) {
+        m_counts.fill(0, kBucketCount);
+    }
+    ++m_counts[bucketIndex(nsecs)];
+    m_nMin = m_nCount ? qMin(m_nMin, nsecs) : nsecs;
+    m_nMax = qMax(m_nMax, nsecs);
+    m_nTotal += nsecs;
+    ++m_nCount;
+}
+
+void LatencyHistogram::reset()
+{
+    if(!m_counts.isEmpty()) {
+        m_counts.fill(0);
+    }
+    m_nCount = 0;
+    m_nTotal = 0;
+    m_nMin = 0;
+    m_nMax = 0;
+}
+
+qint64 LatencyHistogram::percentile(qreal percent) const
+{
+    if(m_nCount == 0) {
+        return 0;
+    }
+
+    const qint64 target = qMax(Q_INT64_C(1), qint64(qBound(qreal(0), percent, qreal(100)) / 100 * m_nCount + 0.5));
+    qint64 seen = 0;
+    for(int i = 0; i < m_counts.size(); ++i) {
+        seen += m_counts.at(i);
+        if(seen >= target) {
+            return qMin(bucketUpperBound(i), m_nMax);
+        }
+    }
+    return m_nMax;
+}
+
+FrameProfiler::FrameProfiler()
+    : m_nTraceCapacity(kDefaultTraceCapacity)
+    , m_nTraceNext(0)
+{
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    s_bEnabled = enabled;
+}
+
+bool FrameProfiler::isEnabled()
+{
+    return s_bEnabled || lcFramelessFrame().isDebugEnabled();
+}
+
+qint64 FrameProfiler::now()
+{
+    return s_processClock()->timer.nsecsElapsed();
+}
+
+const char *FrameProfiler::stageName(Stage stage)
+{
+    static const char *const names[StageCount] = {
+        "paint",
+        "paint.shadowRebuild",
+        "paint.blit",
+        "resize",
+        "resize.mask",
+        "resize.margins",
+        "helper.move",
+        "helper.resize"
+    };
+    return (stage >= 0 && stage < StageCount) ? names[stage] : "unknown";
+}
+
+void FrameProfiler::setName(const QString &name)
+{
+    m_name = name;
+}
+
+void FrameProfiler::record(Stage stage, qint64 start, qint64 nsecs)
+{
+    if(stage < 0 || stage >= StageCount) {
+        return;
+    }
+    m_histograms[stage].record(nsecs);
+
+    if(m_nTraceCapacity > 0) {
+        TraceEvent event;
+        event.start = start;
+        event.nsecs = nsecs;
+        event.stage = stage;
+        if(m_traceEvents.size() < m_nTraceCapacity) {
+            m_traceEvents.append(event);
+        } else {
+            m_traceEvents[m_nTraceNext] = event;
+        }
+        m_nTraceNext = (m_nTraceNext + 1) % m_nTraceCapacity;
+    }
+
+    qCDebug(lcFramelessFrame).nospace() << m_name << ' ' << stageName(stage) << ' ' << nsecs / 1e6 << "ms";
+}
+
+void FrameProfiler::reset()
+{
+    for(int i = 0; i < StageCount; ++i) {
+        m_histograms[i].reset();
+    }
+    m_traceEvents.clear();
+    m_nTraceNext = 0;
+}
+
+const LatencyHistogram &FrameProfiler::histogram(Stage stage) const
+{
+    return m_histograms[qBound(0, int(stage), StageCount - 1)];
+}
+
+void FrameProfiler::setTraceCapacity(int capacity)
+{
+    m_nTraceCapacity = qMax(0, capacity);
+    m_traceEvents.clear();
+    m_nTraceNext = 0;
+}
+
+QString FrameProfiler::summary() const
+{
+    // 名称由调用方指定，可能含有%1等占位符，不能和表头一起链式arg
+    QString text = m_name.isEmpty() ? QString("frameless window") : m_name;
+    text += QString("\n%1 %2 %3 %4 %5 %6 %7\n")
+            .arg("stage", -20).arg("count", 8).arg("mean", 9).arg("p50", 9)
+            .arg("p90", 9).arg("p99", 9).arg("max", 9);
+
+    for(int i = 0; i < StageCount; ++i) {
+        const LatencyHistogram &h = m_histograms[i];
+        if(h.count() == 0) {
+            continue;
+        }
+        text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(stageName(Stage(i)), -20).arg(h.count(), 8)
+                .arg(h.mean() / 1e6, 9, 'f', 3)
+                .arg(h.percentile(50) / 1e6, 9, 'f', 3)
+                .arg(h.percentile(90) / 1e6, 9, 'f', 3)
+                .arg(h.percentile(99) / 1e6, 9, 'f', 3)
+                .arg(h.max() / 1e6, 9, 'f', 3);
+    }
+    return text;
+}
+
+void FrameProfiler::logSummary() const
+{
+    qCInfo(lcFramelessFrame).noquote() << summary();
+}
+
+QByteArray FrameProfiler::chromeTrace() const
+{
+    QJsonArray events;
+    appendTraceEvents(&events, this, 1, traceEventsJson());
+    return toChromeTrace(events);
+}
+
+bool FrameProfiler::saveChromeTrace(const QString &fileName) const
+{
+    return saveChromeTrace(fileName, QList<const FrameProfiler *>() << this);
+}
+
+bool FrameProfiler::saveChromeTrace(const QString &fileName, const QList<const FrameProfiler *> &profilers)
+{
+    QJsonArray events;
+    for(int i = 0; i < profilers.size(); ++i) {
+        if(profilers.at(i)) {
+            appendTraceEvents(&events, profilers.at(i), i + 1, profilers.at(i)->traceEventsJson());
+        }
+    }
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(toChromeTrace(events)) >= 0;
+}
+
+QJsonArray FrameProfiler::traceEventsJson() const
+{
+    QJsonArray events;
+    const int size = m_traceEvents.size();
+    //缓冲区满了以后最早的事件在m_nTraceNext处
+    const int first = (size < m_nTraceCapacity) ? 0 : m_nTraceNext;
+    for(int i = 0; i < size; ++i) {
+        const TraceEvent &traceEvent = m_traceEvents.at((first + i) % size);
+        QJsonObject event;
+        event.insert("name", stageName(Stage(traceEvent.stage)));
+        event.insert("cat", "frameless");
+        event.insert("ph", "X");
+        event.insert("ts", traceEvent.start / 1e3);
+        event.insert("dur", traceEvent.nsecs / 1e3);
+        events.append(event);
+    }
+    return events;
+}
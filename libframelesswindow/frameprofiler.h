@@ -0,0 +1,175 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * frameprofiler.h
+ * 每个窗体的帧耗时统计：绘制、缩放、拖动各阶段的耗时直方图，可导出为Chrome trace JSON。
+ *
+ */
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QVector>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QLoggingCategory>
+
+class QJsonArray;
+
+Q_DECLARE_LOGGING_CATEGORY(lcFramelessFrame)
+
+/**
+ * @brief The LatencyHistogram class
+ *  HDR风格的对数-线性直方图：按2的幂分段，每段再等分16个桶，相对误差约6%，
+ *  桶在第一次记录时才分配(约2.6KB)，没有统计过的窗体不占内存，之后记录一次只是一次数组加一
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(qint64 nsecs);
+    void reset();
+
+    qint64 count() const { return m_nCount; }
+    qint64 min() const { return m_nCount ? m_nMin : 0; }
+    qint64 max() const { return m_nMax; }
+    qreal mean() const { return m_nCount ? qreal(m_nTotal) / m_nCount : 0.0; }
+
+    /**
+     * @brief percentile
+     * @note 百分位数(纳秒)，返回所在桶的上界，不超过最大值
+     * @param percent 0~100
+     */
+    qint64 percentile(qreal percent) const;
+
+private:
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperBound(int index);
+
+private:
+    QVector<quint32> m_counts;     //第一次record时分配
+    qint64 m_nCount;
+    qint64 m_nTotal;
+    qint64 m_nMin;
+    qint64 m_nMax;
+};
+
+/**
+ * @brief The FrameProfiler class
+ *  一个窗体的耗时统计。默认关闭，FrameProfiler::setEnabled(true)或者打开
+ *  frameless.frame分类的debug输出(QT_LOGGING_RULES="frameless.frame.debug=true")后开始统计。
+ *  关闭时各阶段多一次开关判断和一次日志分类(QLoggingCategory::isDebugEnabled)判断，不读时钟
+ */
+class FrameProfiler
+{
+public:
+    enum Stage {
+        Paint = 0,          //paintEvent总耗时
+        PaintShadowRebuild, //重建阴影和客户区背景缓存
+        PaintBlit,          //把缓存或阴影切片画到窗体
+        Resize,             //resizeEvent总耗时
+        ResizeMask,         //生成圆角遮罩
+        ResizeMargins,      //最大化/还原时切换布局边距
+        HelperMove,         //拖动标题栏移动窗体
+        HelperResize,       //拖动边框改变窗体大小
+        StageCount
+    };
+
+    FrameProfiler();
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * @brief now
+     * @note 进程内单调时钟(纳秒)，所有窗体的trace事件使用同一个时间轴
+     */
+    static qint64 now();
+
+    static const char *stageName(Stage stage);
+
+    /**
+     * @brief setName
+     * @note 窗体名称，用于日志和trace中的线程名
+     */
+    void setName(const QString &name);
+    QString name() const { return m_name; }
+
+    void record(Stage stage, qint64 start, qint64 nsecs);
+    void reset();
+
+    const LatencyHistogram &histogram(Stage stage) const;
+
+    /**
+     * @brief setTraceCapacity
+     * @note 保留最近多少个trace事件，默认4096，0表示不保留，只统计直方图
+     */
+    void setTraceCapacity(int capacity);
+
+    /**
+     * @brief summary
+     * @note 各阶段次数、平均值、p50/p90/p99/最大值(毫秒)的文本表格
+     */
+    QString summary() const;
+    // 按info级别把summary输出到frameless.frame分类
+    void logSummary() const;
+
+    /**
+     * @brief chromeTrace
+     * @note Chrome trace-event格式的JSON，可以在chrome://tracing或Perfetto中打开
+     */
+    QByteArray chromeTrace() const;
+    bool saveChromeTrace(const QString &fileName) const;
+    // 多个窗体的trace合并到一个文件，每个窗体一条线程
+    static bool saveChromeTrace(const QString &fileName, const QList<const FrameProfiler *> &profilers);
+
+private:
+    QJsonArray traceEventsJson() const;
+
+private:
+    struct TraceEvent
+    {
+        qint64 start;
+        qint64 nsecs;
+        int stage;
+    };
+
+    QString m_name;
+    LatencyHistogram m_histograms[StageCount];
+    QVector<TraceEvent> m_traceEvents; //环形缓冲
+    int m_nTraceCapacity;
+    int m_nTraceNext;
+};
+
+/**
+ * @brief The FrameProfilerScope class
+ *  记录作用域的耗时，profiler为空或统计关闭时什么也不做
+ */
+class FrameProfilerScope
+{
+public:
+    FrameProfilerScope(FrameProfiler *profiler, FrameProfiler::Stage stage)
+        : m_pProfiler((profiler && FrameProfiler::isEnabled()) ? profiler : nullptr)
+        , m_stage(stage)
+        , m_nStart(m_pProfiler ? FrameProfiler::now() : 0)
+    {
+    }
+
+    ~FrameProfilerScope()
+    {
+        if(m_pProfiler) {
+            m_pProfiler->record(m_stage, m_nStart, FrameProfiler::now() - m_nStart);
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(FrameProfilerScope)
+
+    FrameProfiler *m_pProfiler;
+    FrameProfiler::Stage m_stage;
+    qint64 m_nStart;
+};
+
+#endif // FRAMEPROFILER_H
@@ -0,0 +1,95 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * hittester.cpp
+ * 每个窗体一个的命中测试。
+ *
+ */
+
+#include "hittester.h"
+#include <QPoint>
+#include <QSize>
+
+HitTester::HitTester()
+    : m_nBorderWidth(5)
+    , m_nTitleHeight(30)
+{
+}
+
+void HitTester::setBorderWidth(int width)
+{
+    if(width > 0) {
+        m_nBorderWidth = width;
+    }
+}
+
+void HitTester::setTitleHeight(int height)
+{
+    if(height > 0) {
+        m_nTitleHeight = height;
+    }
+}
+
+void HitTester::addCaptionRect(const QRect &rect)
+{
+    m_captionRects.append(rect);
+}
+
+void HitTester::addClientRect(const QRect &rect)
+{
+    m_clientRects.append(rect);
+}
+
+void HitTester::clearExtraRects()
+{
+    m_captionRects.clear();
+    m_clientRects.clear();
+}
+
+HitTester::Region HitTester::edgeRegion(int x, int y, int width, int height, int border)
+{
+    //负数转成无符号后一定大于宽高，一次比较同时排除两侧
+    if(uint(x) >= uint(width) || uint(y) >= uint(height)) {
+        return Outside;
+    }
+
+    border = qMin(border, qMin(width, height) / 2);
+
+    static const Region regions[3][3] = {
+        { TopLeft,    Top,    TopRight    },
+        { Left,       Client, Right       },
+        { BottomLeft, Bottom, BottomRight }
+    };
+
+    const int col = int(x > border) + int(x >= width - border);
+    const int row = int(y > border) + int(y >= height - border);
+    return regions[row][col];
+}
+
+HitTester::Region HitTester::captionRegion(int x, int y, int titleHeight) const
+{
+    const QPoint pos(x, y);
+    for(int i = 0; i < m_clientRects.size(); ++i) {
+        if(m_clientRects.at(i).contains(pos)) {
+            return Client;
+        }
+    }
+    if(y < titleHeight) {
+        return Caption;
+    }
+    for(int i = 0; i < m_captionRects.size(); ++i) {
+        if(m_captionRects.at(i).contains(pos)) {
+            return Caption;
+        }
+    }
+    return Client;
+}
+
+HitTester::Region HitTester::hitTest(const QPoint &pos, const QSize &size) const
+{
+    const Region region = edgeRegion(pos.x(), pos.y(), size.width(), size.height(), m_nBorderWidth);
+    if(region != Client) {
+        return region;
+    }
+    return captionRegion(pos.x(), pos.y(), m_nTitleHeight);
+}
@@ -0,0 +1,96 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * hittester.h
+ * 每个窗体一个的命中测试，一次计算得到鼠标所在的区域(客户区、标题栏、各边、各角)。
+ *
+ */
+
+#ifndef HITTESTER_H
+#define HITTESTER_H
+
+#include <QRect>
+#include <QVector>
+
+class QPoint;
+class QSize;
+
+/**
+ * @brief The HitTester class
+ *  计算鼠标位于客户区、标题栏，还是左、上、右、下、左上角、右上角、左下角、右下角。
+ *  边框宽度、标题栏高度每个窗体独立，可以额外注册标题栏区域和标题栏中的非标题栏区域。
+ */
+class HitTester
+{
+public:
+    enum Region {
+        Client = 0,
+        Caption,
+        Left,
+        Top,
+        Right,
+        Bottom,
+        TopLeft,
+        TopRight,
+        BottomLeft,
+        BottomRight,
+        Outside
+    };
+
+    HitTester();
+
+    void setBorderWidth(int width);
+    int borderWidth() const { return m_nBorderWidth; }
+
+    void setTitleHeight(int height);
+    int titleHeight() const { return m_nTitleHeight; }
+
+    /**
+     * @brief addCaptionRect
+     * @note 额外注册一块可以拖动窗体的标题栏区域(窗体坐标)
+     * @param rect
+     */
+    void addCaptionRect(const QRect &rect);
+
+    /**
+     * @brief addClientRect
+     * @note 注册标题栏中不能拖动窗体的区域(窗体坐标)，例如标题栏上的按钮，优先于标题栏区域
+     * @param rect
+     */
+    void addClientRect(const QRect &rect);
+
+    void clearExtraRects();
+
+    /**
+     * @brief hitTest
+     * @note 命中测试，pos和size都是逻辑像素。Qt的鼠标事件和窗体大小都是逻辑像素，
+     *  边框宽度、标题栏高度也是逻辑像素，在高分屏上自然按设备像素比放大
+     * @param pos 相对窗体左上角的位置
+     * @param size 窗体大小
+     * @return
+     */
+    Region hitTest(const QPoint &pos, const QSize &size) const;
+
+    /**
+     * @brief edgeRegion
+     * @note 只判断边和角，不在边框上时返回Client，不在窗体内返回Outside。
+     *  与原来的CursorPosCalculator一致，距边缘0到border(含)都算边框
+     */
+    static Region edgeRegion(int x, int y, int width, int height, int border);
+
+    static inline bool isEdge(Region region)
+    {
+        return region >= Left && region <= BottomRight;
+    }
+
+private:
+    Region captionRegion(int x, int y, int titleHeight) const;
+
+private:
+    int m_nBorderWidth;
+    int m_nTitleHeight;
+    QVector<QRect> m_captionRects;
+    QVector<QRect> m_clientRects;
+};
+
+#endif // HITTESTER_H
@@ -0,0 +1,113 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * iconatlas.cpp
+ * 标题栏和提示框图标的全局图集。
+ *
+ */
+
+#include "iconatlas.h"
+#include <QHash>
+#include <QPair>
+#include <QGuiApplication>
+#include <QScreen>
+
+namespace {
+
+struct IconAtlasData
+{
+    IconAtlasData() : decodeCount(0) {}
+
+    //(图标, 设备像素比 * 100) -> 帧
+    QHash<QPair<int, int>, QSharedPointer<const SpriteFrames> > frames;
+    int decodeCount;
+};
+Q_GLOBAL_STATIC(IconAtlasData, s_iconAtlas)
+
+} // namespace
+
+QString IconAtlas::fileName(Icon icon)
+{
+    switch(icon) {
+    case Minimize:
+        return QStringLiteral(":/images/titlebar/min.png");
+    case Maximize:
+        return QStringLiteral(":/images/titlebar/max.png");
+    case Restore:
+        return QStringLiteral(":/images/titlebar/restore.png");
+    case Close:
+        return QStringLiteral(":/images/titlebar/close.png");
+    case Menu:
+        return QStringLiteral(":/images/titlebar/menu.png");
+    case MessageInformation:
+        return QStringLiteral(":/images/msgbox/msg-info-48x48.png");
+    case MessageWarning:
+        return QStringLiteral(":/images/msgbox/msg-warning-48x48.png");
+    case MessageQuestion:
+        return QStringLiteral(":/images/msgbox/msg-question-48x48.png");
+    case MessageError:
+        return QStringLiteral(":/images/msgbox/msg-error-48x48.png");
+    case MessageSuccess:
+        return QStringLiteral(":/images/msgbox/msg-success-48x48.png");
+    default:
+        return QString();
+    }
+}
+
+int IconAtlas::stateCount(Icon icon)
+{
+    return icon < MessageInformation ? 4 : 1;
+}
+
+QSharedPointer<const SpriteFrames> IconAtlas::frames(Icon icon, qreal dpr)
+{
+    const QPair<int, int> key(icon, qRound(dpr * 100));
+    QSharedPointer<const SpriteFrames> &frames = s_iconAtlas()->frames[key];
+    if(!frames) {
+        //经过SpriteAtlas，与按路径加载的按钮共用同一份帧；
+        //按钮已经持有这份帧时不会解码，只统计SpriteAtlas真正解码的次数
+        const int decoded = SpriteAtlas::decodeCount();
+        frames = SpriteAtlas::acquire(fileName(icon), stateCount(icon), dpr);
+        s_iconAtlas()->decodeCount += SpriteAtlas::decodeCount() - decoded;
+    }
+    return frames;
+}
+
+QPixmap IconAtlas::pixmap(Icon icon, qreal dpr)
+{
+    const QSharedPointer<const SpriteFrames> f = frames(icon, dpr);
+    return f->count() > 0 ? f->frame(0) : QPixmap();
+}
+
+void IconAtlas::preload(qreal dpr)
+{
+    QList<qreal> ratios;
+    if(dpr > 0) {
+        ratios << dpr;
+    } else {
+        foreach(QScreen *pScreen, QGuiApplication::screens()) {
+            if(!ratios.contains(pScreen->devicePixelRatio())) {
+                ratios << pScreen->devicePixelRatio();
+            }
+        }
+        if(ratios.isEmpty()) {
+            ratios << 1.0;
+        }
+    }
+
+    foreach(qreal ratio, ratios) {
+        for(int i = 0; i < IconCount; ++i) {
+            frames(Icon(i), ratio);
+        }
+    }
+}
+
+void IconAtlas::clear()
+{
+    s_iconAtlas()->frames.clear();
+}
+
+int IconAtlas::decodeCount()
+{
+    return s_iconAtlas()->decodeCount;
+}
@@ -0,0 +1,82 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * iconatlas.h
+ * 标题栏和提示框图标的全局图集，每个图标在每种设备像素比下只解码一次。
+ *
+ */
+
+#ifndef ICONATLAS_H
+#define ICONATLAS_H
+
+#include <QPixmap>
+#include <QSharedPointer>
+#include "spriteatlas.h"
+
+/**
+ * @brief The IconAtlas class
+ *  库内置图标的图集。第一次使用或preload时解码并切片，之后一直持有，
+ *  创建窗体、切换最大化/还原都只是取共享的句柄，不再解码PNG。只能在GUI线程中使用。
+ */
+class IconAtlas
+{
+public:
+    enum Icon {
+        Minimize = 0,
+        Maximize,
+        Restore,
+        Close,
+        Menu,
+        MessageInformation,
+        MessageWarning,
+        MessageQuestion,
+        MessageError,
+        MessageSuccess,
+        IconCount
+    };
+
+    /**
+     * @brief fileName
+     * @note 图标的资源路径
+     */
+    static QString fileName(Icon icon);
+
+    /**
+     * @brief stateCount
+     * @note 图标包含的状态数，标题栏按钮为4(normal/hover/pressed/disabled)，提示框图标为1
+     */
+    static int stateCount(Icon icon);
+
+    /**
+     * @brief frames
+     * @note 图标在dpr下的各状态帧，没有时解码一次
+     */
+    static QSharedPointer<const SpriteFrames> frames(Icon icon, qreal dpr);
+
+    /**
+     * @brief pixmap
+     * @note 图标在dpr下的第一帧(normal)，隐式共享
+     */
+    static QPixmap pixmap(Icon icon, qreal dpr);
+
+    /**
+     * @brief preload
+     * @note 启动时预先解码所有图标
+     * @param dpr 小于等于0时按所有屏幕的设备像素比各解码一份
+     */
+    static void preload(qreal dpr = 0);
+
+    /**
+     * @brief clear
+     * @note 释放图集持有的图标，正在使用的按钮不受影响
+     */
+    static void clear();
+
+    /**
+     * @brief decodeCount
+     * @note 图集解码图标的累计次数
+     */
+    static int decodeCount();
+};
+
+#endif // ICONATLAS_H
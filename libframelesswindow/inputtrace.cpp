@@ -0,0 +1,304 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * inputtrace.cpp
+ * 鼠标事件流的录制、保存和回放。
+ *
+ */
+
+#include "inputtrace.h"
+#include <QWidget>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QFile>
+#include <QDataStream>
+#include <QCoreApplication>
+
+namespace {
+
+const quint32 kTraceMagic = 0x464C5452; // "FLTR"
+const quint16 kTraceVersion = 1;
+
+const int kModifierShift = 25;
+
+} // namespace
+
+InputTrace::InputTrace()
+{
+}
+
+void InputTrace::clear()
+{
+    m_windowSize = QSize();
+    m_events.clear();
+}
+
+qint64 InputTrace::duration() const
+{
+    if(m_events.isEmpty()) {
+        return 0;
+    }
+    return m_events.last().time - m_events.first().time;
+}
+
+bool InputTrace::save(QIODevice *device) const
+{
+    QDataStream out(device);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << kTraceMagic << kTraceVersion
+        << qint32(m_windowSize.width()) << qint32(m_windowSize.height())
+        << quint32(m_events.size());
+
+    qint64 lastTime = 0;
+    for(int i = 0; i < m_events.size(); ++i) {
+        const InputTraceEvent &event = m_events.at(i);
+        const qint64 delta = qBound(Q_INT64_C(0), event.time - lastTime, qint64(0xffffffffu));
+        lastTime = event.time;
+
+        out << event.type << event.button << event.buttons << event.modifiers
+            << quint32(delta) << qint32(event.pos.x()) << qint32(event.pos.y());
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+bool InputTrace::save(const QString &fileName) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return save(&file);
+}
+
+bool InputTrace::load(QIODevice *device)
+{
+    clear();
+
+    QDataStream in(device);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    quint32 count = 0;
+    in >> magic >> version >> width >> height >> count;
+    if(in.status() != QDataStream::Ok || magic != kTraceMagic || version != kTraceVersion) {
+        return false;
+    }
+
+    m_windowSize = QSize(width, height);
+    m_events.reserve(int(qMin(count, quint32(1) << 24)));
+
+    qint64 time = 0;
+    for(quint32 i = 0; i < count; ++i) {
+        InputTraceEvent event;
+        quint32 delta = 0;
+        qint32 x = 0;
+        qint32 y = 0;
+        in >> event.type >> event.button >> event.buttons >> event.modifiers >> delta >> x >> y;
+        if(in.status() != QDataStream::Ok) {
+            clear();
+            return false;
+        }
+        time += delta;
+        event.time = time;
+        event.pos = QPoint(x, y);
+        m_events.append(event);
+    }
+    return true;
+}
+
+bool InputTrace::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return load(&file);
+}
+
+InputTraceRecorder::InputTraceRecorder()
+    : m_bRecording(false)
+{
+}
+
+void InputTraceRecorder::start(QWidget *window)
+{
+    m_pWindow = window;
+    m_trace.clear();
+    if(window) {
+        m_ptOrigin = window->frameGeometry().topLeft();
+        m_trace.setWindowSize(window->size());
+    }
+    m_clock.start();
+    m_bRecording = (window != nullptr);
+}
+
+void InputTraceRecorder::stop()
+{
+    m_bRecording = false;
+}
+
+bool InputTraceRecorder::isRecording() const
+{
+    return m_bRecording;
+}
+
+void InputTraceRecorder::record(QWidget *window, QEvent *event)
+{
+    if(!m_bRecording || window != m_pWindow) {
+        return;
+    }
+
+    InputTraceEvent traceEvent;
+    switch(event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseMove:
+    {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if(event->type() == QEvent::MouseButtonPress) {
+            traceEvent.type = InputTraceEvent::MousePress;
+        } else if(event->type() == QEvent::MouseButtonRelease) {
+            traceEvent.type = InputTraceEvent::MouseRelease;
+        } else {
+            traceEvent.type = InputTraceEvent::MouseMove;
+        }
+        traceEvent.button = quint8(mouseEvent->button());
+        traceEvent.buttons = quint8(mouseEvent->buttons());
+        traceEvent.modifiers = quint8(int(mouseEvent->modifiers()) >> kModifierShift);
+        traceEvent.pos = mouseEvent->globalPos() - m_ptOrigin;
+        break;
+    }
+    case QEvent::HoverMove:
+    {
+        QHoverEvent *hoverEvent = static_cast<QHoverEvent *>(event);
+        traceEvent.type = InputTraceEvent::HoverMove;
+        traceEvent.modifiers = quint8(int(hoverEvent->modifiers()) >> kModifierShift);
+        traceEvent.pos = window->mapToGlobal(hoverEvent->pos()) - m_ptOrigin;
+        break;
+    }
+    case QEvent::Leave:
+        traceEvent.type = InputTraceEvent::Leave;
+        break;
+    default:
+        return;
+    }
+
+    traceEvent.time = m_clock.nsecsElapsed() / 1000;
+    m_trace.append(traceEvent);
+}
+
+InputTraceReplayer::InputTraceReplayer(QObject *parent)
+    : QObject(parent)
+    , m_pWindow(nullptr)
+    , m_nRepaints(0)
+{
+}
+
+InputTraceReport InputTraceReplayer::replay(const InputTrace &trace, QWidget *window, Speed speed)
+{
+    InputTraceReport report;
+    if(!window) {
+        return report;
+    }
+
+    if(trace.windowSize().isValid()) {
+        window->resize(trace.windowSize());
+    }
+    QCoreApplication::processEvents();
+
+    m_pWindow = window;
+    m_nRepaints = 0;
+    m_ptLastPos = QPoint();
+    window->installEventFilter(this);
+
+    const QPoint origin = window->frameGeometry().topLeft();
+    const QVector<InputTraceEvent> &events = trace.events();
+    report.eventNsecs.reserve(events.size());
+
+    const qint64 startTime = events.isEmpty() ? 0 : events.first().time;
+    QElapsedTimer clock;
+    clock.start();
+    QElapsedTimer timer;
+
+    for(int i = 0; i < events.size(); ++i) {
+        const InputTraceEvent &event = events.at(i);
+
+        if(speed == OriginalSpeed) {
+            // 等到录制时的时间点，期间照常处理定时器等事件
+            while(clock.nsecsElapsed() / 1000 < event.time - startTime) {
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+            }
+        }
+
+        const QRect before = window->geometry();
+
+        timer.start();
+        sendEvent(window, event, origin);
+        // 事件引起的update()在这里完成绘制，计入这个事件的耗时
+        QCoreApplication::processEvents();
+        const qint64 nsecs = timer.nsecsElapsed();
+
+        report.eventNsecs.append(nsecs);
+        report.totalNsecs += nsecs;
+        report.maxEventNsecs = qMax(report.maxEventNsecs, nsecs);
+        if(window->geometry() != before) {
+            ++report.geometryChanges;
+        }
+    }
+
+    window->removeEventFilter(this);
+    report.repaints = m_nRepaints;
+    m_pWindow = nullptr;
+    return report;
+}
+
+bool InputTraceReplayer::eventFilter(QObject *obj, QEvent *event)
+{
+    if(obj == m_pWindow && event->type() == QEvent::Paint) {
+        ++m_nRepaints;
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void InputTraceReplayer::sendEvent(QWidget *window, const InputTraceEvent &event, const QPoint &origin)
+{
+    const QPoint globalPos = origin + event.pos;
+    const QPoint localPos = window->mapFromGlobal(globalPos);
+    const Qt::KeyboardModifiers modifiers(QFlag(int(event.modifiers) << kModifierShift));
+
+    switch(event.type) {
+    case InputTraceEvent::MousePress:
+    case InputTraceEvent::MouseRelease:
+    case InputTraceEvent::MouseMove:
+    {
+        QEvent::Type type = QEvent::MouseMove;
+        if(event.type == InputTraceEvent::MousePress) {
+            type = QEvent::MouseButtonPress;
+        } else if(event.type == InputTraceEvent::MouseRelease) {
+            type = QEvent::MouseButtonRelease;
+        }
+        QMouseEvent mouseEvent(type, localPos, localPos, globalPos,
+                               Qt::MouseButton(event.button), Qt::MouseButtons(QFlag(event.buttons)), modifiers);
+        QCoreApplication::sendEvent(window, &mouseEvent);
+        break;
+    }
+    case InputTraceEvent::HoverMove:
+    {
+        QHoverEvent hoverEvent(QEvent::HoverMove, localPos, m_ptLastPos, modifiers);
+        QCoreApplication::sendEvent(window, &hoverEvent);
+        break;
+    }
+    case InputTraceEvent::Leave:
+    {
+        QEvent leaveEvent(QEvent::Leave);
+        QCoreApplication::sendEvent(window, &leaveEvent);
+        break;
+    }
+    default:
+        break;
+    }
+    m_ptLastPos = localPos;
+}
@@ -0,0 +1,172 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * inputtrace.h
+ * 录制窗体收到的原始鼠标事件流，保存为紧凑的二进制文件，并可以在其他窗体上按原速或最快速度回放。
+ *
+ */
+
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+#include <QObject>
+#include <QPoint>
+#include <QSize>
+#include <QVector>
+#include <QPointer>
+#include <QElapsedTimer>
+
+class QWidget;
+class QEvent;
+class QIODevice;
+
+/**
+ * @brief The InputTraceEvent struct
+ *  一个鼠标事件，位置相对录制开始时窗体的左上角(全局坐标)，回放时平移到回放窗体上
+ */
+struct InputTraceEvent
+{
+    enum Type {
+        MousePress = 0,
+        MouseRelease,
+        MouseMove,
+        HoverMove,
+        Leave
+    };
+
+    InputTraceEvent()
+        : type(MouseMove), button(0), buttons(0), modifiers(0), time(0) {}
+
+    quint8 type;      //Type
+    quint8 button;    //Qt::MouseButton
+    quint8 buttons;   //Qt::MouseButtons
+    quint8 modifiers; //Qt::KeyboardModifiers >> 25
+    qint64 time;      //距录制开始的微秒数
+    QPoint pos;
+};
+
+/**
+ * @brief The InputTrace class
+ *  录制得到的事件流。文件格式：
+ *  魔数、版本、窗体大小、事件数，之后每个事件为类型、按键、修饰键、与上一个事件的时间差(微秒)、位置，共16字节
+ */
+class InputTrace
+{
+public:
+    InputTrace();
+
+    QSize windowSize() const { return m_windowSize; }
+    void setWindowSize(const QSize &size) { m_windowSize = size; }
+
+    const QVector<InputTraceEvent> &events() const { return m_events; }
+    void append(const InputTraceEvent &event) { m_events.append(event); }
+    void clear();
+
+    /**
+     * @brief duration
+     * @note 第一个事件到最后一个事件的微秒数
+     */
+    qint64 duration() const;
+
+    bool save(QIODevice *device) const;
+    bool save(const QString &fileName) const;
+    bool load(QIODevice *device);
+    bool load(const QString &fileName);
+
+private:
+    QSize m_windowSize;
+    QVector<InputTraceEvent> m_events;
+};
+
+/**
+ * @brief The InputTraceRecorder class
+ *  通过FramelessHelper::setInputTraceRecorder安装，在WidgetData的事件过滤器中记录鼠标事件
+ */
+class InputTraceRecorder
+{
+public:
+    InputTraceRecorder();
+
+    /**
+     * @brief start
+     * @note 开始录制窗体的鼠标事件，清空之前的记录
+     * @param window 只记录这个窗体的事件
+     */
+    void start(QWidget *window);
+    void stop();
+    bool isRecording() const;
+
+    /**
+     * @brief record
+     * @note 由事件过滤器调用，不是鼠标事件或者不是录制的窗体时忽略
+     */
+    void record(QWidget *window, QEvent *event);
+
+    const InputTrace &trace() const { return m_trace; }
+
+private:
+    QPointer<QWidget> m_pWindow;
+    QElapsedTimer m_clock;
+    QPoint m_ptOrigin;       // 开始录制时窗体的左上角
+    InputTrace m_trace;
+    bool m_bRecording;
+};
+
+/**
+ * @brief The InputTraceReport struct
+ *  回放结果：每个事件的处理耗时(包括事件引起的绘制)，窗体位置大小改变次数，窗体绘制次数
+ */
+struct InputTraceReport
+{
+    InputTraceReport()
+        : totalNsecs(0), maxEventNsecs(0), geometryChanges(0), repaints(0) {}
+
+    qint64 totalNsecs;
+    qint64 maxEventNsecs;
+    QVector<qint64> eventNsecs;
+    int geometryChanges;
+    int repaints;
+
+    qreal averageEventNsecs() const
+    {
+        return eventNsecs.isEmpty() ? 0.0 : qreal(totalNsecs) / eventNsecs.size();
+    }
+};
+
+/**
+ * @brief The InputTraceReplayer class
+ *  把事件流直接发送给窗体，可以在offscreen平台上运行
+ */
+class InputTraceReplayer : public QObject
+{
+public:
+    enum Speed {
+        OriginalSpeed = 0, //按录制时的时间间隔
+        MaximumSpeed       //处理完一个事件立即发送下一个
+    };
+
+    explicit InputTraceReplayer(QObject *parent = nullptr);
+
+    /**
+     * @brief replay
+     * @note 先把窗体调整为录制时的大小，再从窗体当前位置开始回放
+     * @param trace
+     * @param window
+     * @param speed
+     * @return
+     */
+    InputTraceReport replay(const InputTrace &trace, QWidget *window, Speed speed = MaximumSpeed);
+
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event);
+
+private:
+    void sendEvent(QWidget *window, const InputTraceEvent &event, const QPoint &origin);
+
+private:
+    QWidget *m_pWindow;
+    int m_nRepaints;
+    QPoint m_ptLastPos;
+};
+
+#endif // INPUTTRACE_H
@@ -5,6 +5,7 @@ DEFINES += FRAMELESSWINDOW_LIBRARY
 
 HEADERS += \
     $$PWD/cursorposcalculator.h \
+    $$PWD/hittester.h \
     $$PWD/framelesshelper.h \
     $$PWD/framelesshelperprivate.h \
     $$PWD/framelesswindow.h \
@@ -13,16 +14,54 @@ HEADERS += \
     $$PWD/titlebar.h \
     $$PWD/borderimage.h \
     $$PWD/statebutton.h \
-    $$PWD/widgetshadow.h
+    $$PWD/widgetshadow.h \
+    $$PWD/shadowtilecache.h \
+    $$PWD/shadowgenerator.h \
+    $$PWD/roundedmask.h \
+    $$PWD/screentracker.h \
+    $$PWD/inputtrace.h \
+    $$PWD/frameprofiler.h \
+    $$PWD/spriteatlas.h \
+    $$PWD/iconatlas.h \
+    $$PWD/litetitlebar.h \
+    $$PWD/messageboxpool.h \
+    $$PWD/notificationqueue.h \
+    $$PWD/mpscqueue.h \
+    $$PWD/messageboxdispatcher.h \
+    $$PWD/themeengine.h
 
 SOURCES += \
     $$PWD/cursorposcalculator.cpp \
+    $$PWD/hittester.cpp \
     $$PWD/framelesshelper.cpp \
     $$PWD/framelesswindow.cpp \
     $$PWD/widgetdata.cpp \
     $$PWD/titlebar.cpp \
     $$PWD/borderimage.cpp \
-    $$PWD/statebutton.cpp
+    $$PWD/statebutton.cpp \
+    $$PWD/shadowtilecache.cpp \
+    $$PWD/shadowgenerator.cpp \
+    $$PWD/roundedmask.cpp \
+    $$PWD/screentracker.cpp \
+    $$PWD/inputtrace.cpp \
+    $$PWD/frameprofiler.cpp \
+    $$PWD/spriteatlas.cpp \
+    $$PWD/iconatlas.cpp \
+    $$PWD/litetitlebar.cpp \
+    $$PWD/messageboxpool.cpp \
+    $$PWD/notificationqueue.cpp \
+    $$PWD/messageboxdispatcher.cpp \
+    $$PWD/themeengine.cpp
+
+# 阴影模糊的AVX2实现按函数单独编译、运行时检测CPU，需要qsimd_p.h
+QT += core-private
+
+# 判断桌面是否有合成器，没有时圆角改用窗口遮罩
+win32: LIBS += -ldwmapi
+unix:!macx:qtHaveModule(x11extras) {
+    QT += x11extras
+    DEFINES += FRAMELESS_HAS_X11EXTRAS
+}
 
 RESOURCES += \
     $$PWD/images.qrc \
@@ -0,0 +1,369 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * litetitlebar.cpp
+ * 单个控件的轻量标题栏，自己绘制图标、标题和按钮。
+ *
+ */
+
+#include "litetitlebar.h"
+#include "iconatlas.h"
+#include <QEvent>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+
+namespace {
+
+const int kTitleHeight = 30;
+const int kButtonWidth = 30;
+const int kIconSize = 20;
+const int kSpacing = 5;
+
+} // namespace
+
+LiteTitleBar::LiteTitleBar(QWidget *parent)
+    : AbstractTitleBar(parent)
+    , m_dFramesDpr(0)
+    , m_hoverButton(kNoButton)
+    , m_pressedButton(kNoButton)
+    , m_bMaximized(false)
+    , m_bMaximizeDisabled(false)
+    , m_bIconVisible(true)
+    , m_nElidedWidth(-1)
+{
+    setFixedHeight(kTitleHeight);
+    //没有子控件，悬停状态需要自己跟踪
+    setMouseTracking(true);
+
+    for(int i = 0; i < kButtonCount; ++i) {
+        m_bButtonVisible[i] = true;
+    }
+    m_elidedTitle.setTextFormat(Qt::PlainText);
+
+    //宿主窗口在创建标题栏之前就可能设置了标题和图标
+    QWidget *pWindow = this->window();
+    m_title = pWindow->windowTitle();
+    if(!pWindow->windowIcon().isNull()) {
+        m_icon = pWindow->windowIcon().pixmap(kIconSize, kIconSize);
+    }
+    m_bMaximized = pWindow->isMaximized();
+
+    updateLayout();
+}
+
+LiteTitleBar::~LiteTitleBar()
+{
+
+}
+
+void LiteTitleBar::setMinimumVisible(bool minimum)
+{
+    if(!minimum) {
+        m_bButtonVisible[kMinimizeButton] = false;
+        updateLayout();
+        update();
+    }
+}
+
+void LiteTitleBar::setMaximumVisible(bool maximum)
+{
+    if(!maximum) {
+        m_bButtonVisible[kMaximizeButton] = false;
+        updateLayout();
+        update();
+    }
+}
+
+void LiteTitleBar::setMaximizeDisabled()
+{
+    m_bMaximizeDisabled = true;
+}
+
+void LiteTitleBar::hideTitleIcon()
+{
+    m_bIconVisible = false;
+    updateLayout();
+    update();
+}
+
+void LiteTitleBar::showTitleIcon()
+{
+    m_bIconVisible = true;
+    updateLayout();
+    update();
+}
+
+bool LiteTitleBar::eventFilter(QObject *obj, QEvent *event)
+{
+    switch(event->type()) {
+    case QEvent::WindowTitleChange:
+    {
+        QWidget *pWidget = qobject_cast<QWidget *>(obj);
+        if(pWidget) {
+            m_title = pWidget->windowTitle();
+            m_nElidedWidth = -1;
+            update(m_titleRect);
+        }
+        return false;
+    }
+    case QEvent::WindowIconChange:
+    {
+        QWidget *pWidget = qobject_cast<QWidget *>(obj);
+        if(pWidget) {
+            m_icon = pWidget->windowIcon().pixmap(kIconSize, kIconSize);
+            update(m_iconRect);
+        }
+        return false;
+    }
+    case QEvent::WindowStateChange:
+    case QEvent::Resize:
+        updateMaximize();
+        return false;
+    default:
+        return QWidget::eventFilter(obj, event);
+    }
+}
+
+bool LiteTitleBar::event(QEvent *event)
+{
+    if(event->type() == QEvent::ToolTip) {
+        QHelpEvent *pHelpEvent = static_cast<QHelpEvent *>(event);
+        const Button button = buttonAt(pHelpEvent->pos());
+        if(button != kNoButton) {
+            QToolTip::showText(pHelpEvent->globalPos(), buttonToolTip(button), this, m_buttonRects[button]);
+        } else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+        return true;
+    }
+    return AbstractTitleBar::event(event);
+}
+
+void LiteTitleBar::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if(!qFuzzyCompare(m_dFramesDpr, devicePixelRatioF())) {
+        updateButtonFrames();
+    }
+
+    QPainter painter(this);
+
+    if(m_bIconVisible && !m_icon.isNull()) {
+        painter.drawPixmap(m_iconRect, m_icon);
+    }
+
+    const QStaticText &title = elidedTitle();
+    if(!m_title.isEmpty()) {
+        painter.setPen(palette().color(QPalette::WindowText));
+        const int y = m_titleRect.top() + (m_titleRect.height() - qRound(title.size().height())) / 2;
+        painter.drawStaticText(m_titleRect.left(), y, title);
+    }
+
+    //状态帧：0正常 1悬停 2按下 3禁用
+    for(int i = 0; i < kButtonCount; ++i) {
+        if(!m_bButtonVisible[i] || !m_buttonFrames[i]) {
+            continue;
+        }
+        int state = 0;
+        if(!isEnabled()) {
+            state = 3;
+        } else if(m_hoverButton == i) {
+            state = (m_pressedButton == i) ? 2 : 1;
+        }
+        const SpriteFrames &frames = *m_buttonFrames[i];
+        painter.drawPixmap(m_buttonRects[i], frames.frame(qMin(state, frames.count() - 1)));
+    }
+}
+
+void LiteTitleBar::resizeEvent(QResizeEvent *event)
+{
+    AbstractTitleBar::resizeEvent(event);
+    updateLayout();
+}
+
+void LiteTitleBar::changeEvent(QEvent *event)
+{
+    if(event->type() == QEvent::FontChange) {
+        m_nElidedWidth = -1;
+        update(m_titleRect);
+    }
+    AbstractTitleBar::changeEvent(event);
+}
+
+void LiteTitleBar::mousePressEvent(QMouseEvent *event)
+{
+    const Button button = buttonAt(event->pos());
+    if(event->button() != Qt::LeftButton || button == kNoButton) {
+        //交给宿主窗口拖动
+        event->ignore();
+        return;
+    }
+    m_pressedButton = button;
+    update(m_buttonRects[button]);
+}
+
+void LiteTitleBar::mouseReleaseEvent(QMouseEvent *event)
+{
+    if(event->button() != Qt::LeftButton || m_pressedButton == kNoButton) {
+        event->ignore();
+        return;
+    }
+    const Button pressed = m_pressedButton;
+    m_pressedButton = kNoButton;
+    update(m_buttonRects[pressed]);
+    //和按钮一样，只有在同一个按钮上释放才触发
+    if(buttonAt(event->pos()) == pressed) {
+        triggerButton(pressed);
+    }
+}
+
+void LiteTitleBar::mouseMoveEvent(QMouseEvent *event)
+{
+    setHoverButton(buttonAt(event->pos()));
+    if(m_pressedButton == kNoButton) {
+        event->ignore();
+    }
+}
+
+void LiteTitleBar::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    if(buttonAt(event->pos()) != kNoButton) {
+        return;
+    }
+    if(m_bMaximizeDisabled) {
+        return;
+    }
+    triggerButton(kMaximizeButton);
+}
+
+void LiteTitleBar::leaveEvent(QEvent *event)
+{
+    setHoverButton(kNoButton);
+    AbstractTitleBar::leaveEvent(event);
+}
+
+void LiteTitleBar::updateLayout()
+{
+    const int h = height();
+    int right = width();
+    for(int i = kButtonCount - 1; i >= 0; --i) {
+        if(m_bButtonVisible[i]) {
+            right -= kButtonWidth;
+            m_buttonRects[i] = QRect(right, 0, kButtonWidth, h);
+        } else {
+            m_buttonRects[i] = QRect();
+        }
+    }
+
+    int left = kSpacing;
+    if(m_bIconVisible) {
+        m_iconRect = QRect(left, (h - kIconSize) / 2, kIconSize, kIconSize);
+        left += kIconSize + kSpacing;
+    } else {
+        m_iconRect = QRect();
+    }
+    m_titleRect = QRect(left, 0, qMax(0, right - left), h);
+}
+
+void LiteTitleBar::updateMaximize()
+{
+    QWidget *pWindow = this->window();
+    if(!pWindow->isTopLevel()) {
+        return;
+    }
+    const bool maximized = pWindow->isMaximized();
+    //只在最大化状态切换时更换图标
+    if(maximized == m_bMaximized) {
+        return;
+    }
+    m_bMaximized = maximized;
+    if(m_dFramesDpr > 0) {
+        m_buttonFrames[kMaximizeButton] = IconAtlas::frames(m_bMaximized ? IconAtlas::Restore : IconAtlas::Maximize,
+                                                            m_dFramesDpr);
+    }
+    update(m_buttonRects[kMaximizeButton]);
+}
+
+void LiteTitleBar::updateButtonFrames()
+{
+    m_dFramesDpr = devicePixelRatioF();
+    m_buttonFrames[kMinimizeButton] = IconAtlas::frames(IconAtlas::Minimize, m_dFramesDpr);
+    m_buttonFrames[kMaximizeButton] = IconAtlas::frames(m_bMaximized ? IconAtlas::Restore : IconAtlas::Maximize,
+                                                        m_dFramesDpr);
+    m_buttonFrames[kCloseButton] = IconAtlas::frames(IconAtlas::Close, m_dFramesDpr);
+}
+
+void LiteTitleBar::setHoverButton(Button button)
+{
+    if(button == m_hoverButton) {
+        return;
+    }
+    if(m_hoverButton != kNoButton) {
+        update(m_buttonRects[m_hoverButton]);
+    }
+    m_hoverButton = button;
+    if(m_hoverButton != kNoButton) {
+        update(m_buttonRects[m_hoverButton]);
+    }
+}
+
+LiteTitleBar::Button LiteTitleBar::buttonAt(const QPoint &pos) const
+{
+    for(int i = 0; i < kButtonCount; ++i) {
+        if(m_bButtonVisible[i] && m_buttonRects[i].contains(pos)) {
+            return Button(i);
+        }
+    }
+    return kNoButton;
+}
+
+void LiteTitleBar::triggerButton(Button button)
+{
+    QWidget *pWindow = this->window();
+    if(!pWindow->isTopLevel()) {
+        return;
+    }
+    switch(button) {
+    case kMinimizeButton:
+        pWindow->showMinimized();
+        break;
+    case kMaximizeButton:
+        toggleMaximize();
+        updateMaximize();
+        break;
+    case kCloseButton:
+        pWindow->close();
+        break;
+    default:
+        break;
+    }
+}
+
+QString LiteTitleBar::buttonToolTip(Button button) const
+{
+    switch(button) {
+    case kMinimizeButton:
+        return tr("Minimize");
+    case kMaximizeButton:
+        return m_bMaximized ? tr("Restore") : tr("Maximize");
+    case kCloseButton:
+        return tr("Close");
+    default:
+        return QString();
+    }
+}
+
+const QStaticText &LiteTitleBar::elidedTitle()
+{
+    const int width = m_titleRect.width();
+    if(width != m_nElidedWidth) {
+        m_elidedTitle.setText(fontMetrics().elidedText(m_title, Qt::ElideRight, width));
+        m_elidedTitle.prepare(QTransform(), font());
+        m_nElidedWidth = width;
+    }
+    return m_elidedTitle;
+}
@@ -0,0 +1,92 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * litetitlebar.h
+ * 单个控件的轻量标题栏，自己绘制图标、标题和按钮。
+ *
+ */
+
+#ifndef LITETITLEBAR_H
+#define LITETITLEBAR_H
+
+#include "titlebar.h"
+#include "spriteatlas.h"
+#include <QSharedPointer>
+#include <QStaticText>
+
+/**
+ * @brief The LiteTitleBar class
+ *  与TitleBar接口相同，但整个标题栏只有一个控件，没有布局和子控件的polish，
+ *  适合大量创建、很快关闭的工具窗口。按钮的命中测试、悬停和按下状态都由自己处理，
+ *  省略后的标题文字缓存到标题或宽度改变为止
+ */
+class LiteTitleBar : public AbstractTitleBar
+{
+    Q_OBJECT
+public:
+    explicit LiteTitleBar(QWidget *parent = nullptr);
+    ~LiteTitleBar();
+
+    virtual void setMinimumVisible(bool minimum);
+    virtual void setMaximumVisible(bool maximum);
+    virtual void setMaximizeDisabled();
+    virtual void hideTitleIcon();
+    virtual void showTitleIcon();
+
+protected:
+    /**
+     * @brief eventFilter
+     * @note 宿主窗口的标题、图标、最大化状态
+     */
+    virtual bool eventFilter(QObject *obj, QEvent *event);
+    virtual bool event(QEvent *event);
+    virtual void paintEvent(QPaintEvent *event);
+    virtual void resizeEvent(QResizeEvent *event);
+    virtual void changeEvent(QEvent *event);
+    virtual void mousePressEvent(QMouseEvent *event);
+    virtual void mouseReleaseEvent(QMouseEvent *event);
+    virtual void mouseMoveEvent(QMouseEvent *event);
+    virtual void mouseDoubleClickEvent(QMouseEvent *event);
+    virtual void leaveEvent(QEvent *event);
+
+private:
+    enum Button {
+        kNoButton = -1,
+        kMinimizeButton = 0,
+        kMaximizeButton,
+        kCloseButton,
+        kButtonCount
+    };
+
+    // 按钮从右向左排列，标题占据图标和按钮之间的区域
+    void updateLayout();
+    // 最大化状态切换时换成还原/最大化图标
+    void updateMaximize();
+    // 按当前设备像素比取按钮图标
+    void updateButtonFrames();
+    void setHoverButton(Button button);
+    Button buttonAt(const QPoint &pos) const;
+    void triggerButton(Button button);
+    QString buttonToolTip(Button button) const;
+    // 省略后的标题，标题或宽度改变后才重新计算
+    const QStaticText &elidedTitle();
+
+private:
+    QRect m_buttonRects[kButtonCount];
+    bool m_bButtonVisible[kButtonCount];
+    QSharedPointer<const SpriteFrames> m_buttonFrames[kButtonCount];
+    qreal m_dFramesDpr;
+    Button m_hoverButton;
+    Button m_pressedButton;
+    bool m_bMaximized;
+    bool m_bMaximizeDisabled;
+    bool m_bIconVisible;
+    QRect m_iconRect;
+    QRect m_titleRect;
+    QPixmap m_icon;
+    QString m_title;
+    QStaticText m_elidedTitle;
+    int m_nElidedWidth;        // m_elidedTitle对应的宽度，-1表示需要重新计算
+};
+
+#endif // LITETITLEBAR_H
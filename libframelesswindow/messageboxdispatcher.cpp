@@ -0,0 +1,135 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * messageboxdispatcher.cpp
+ * 把任意线程的提示框请求转到GUI线程成批弹出。
+ *
+ */
+
+#include "messageboxdispatcher.h"
+#include <QCoreApplication>
+#include <QEvent>
+
+namespace {
+
+const int kMaxBatch = 64;   // 每次事件循环最多弹出的提示框，剩下的留到下一次
+
+QEvent::Type drainEventType()
+{
+    static const QEvent::Type type = QEvent::Type(QEvent::registerEventType());
+    return type;
+}
+
+} // namespace
+
+Q_GLOBAL_STATIC(MessageBoxDispatcher, s_dispatcher)
+
+MessageBoxDispatcher::MessageBoxDispatcher()
+    : m_nNextId(0)
+    , m_nBatches(0)
+    , m_nDrained(0)
+{
+    //第一次可能在工作线程中创建，事件要在GUI线程处理。
+    //FramelessMessageBox::post保证创建时已经有QApplication
+    Q_ASSERT(QCoreApplication::instance());
+    moveToThread(QCoreApplication::instance()->thread());
+}
+
+MessageBoxDispatcher::~MessageBoxDispatcher()
+{
+    //程序退出时还没弹出、或者弹出后还没关闭的请求按取消完成，等待的线程不会一直阻塞
+    MessageBoxRequest request;
+    while(m_queue.pop(request)) {
+        request.future.reportCanceled();
+        request.future.reportFinished();
+    }
+    for(QHash<int, QFutureInterface<QMessageBox::StandardButton> >::iterator it = m_showing.begin();
+            it != m_showing.end(); ++it) {
+        it->reportCanceled();
+        it->reportFinished();
+    }
+    m_showing.clear();
+}
+
+MessageBoxDispatcher *MessageBoxDispatcher::instance()
+{
+    return s_dispatcher();
+}
+
+QFuture<QMessageBox::StandardButton> MessageBoxDispatcher::canceledFuture()
+{
+    QFutureInterface<QMessageBox::StandardButton> future;
+    future.reportStarted();
+    future.reportCanceled();
+    future.reportFinished();
+    return future.future();
+}
+
+QFuture<QMessageBox::StandardButton> MessageBoxDispatcher::post(const QString &title, const QString &text,
+        QMessageBox::StandardButtons buttons, FramelessMessageBox::IconType icon,
+        QMessageBox::StandardButton defaultButton)
+{
+    MessageBoxRequest request;
+    request.title = title;
+    request.text = text;
+    request.buttons = buttons;
+    request.defaultButton = defaultButton;
+    request.icon = icon;
+    request.future.reportStarted();
+
+    QFuture<QMessageBox::StandardButton> future = request.future.future();
+    m_queue.push(request);
+    wake();
+    return future;
+}
+
+bool MessageBoxDispatcher::event(QEvent *event)
+{
+    if(event->type() == drainEventType()) {
+        drain();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+void MessageBoxDispatcher::wake()
+{
+    //已经有一个事件在路上时不再投递，一次事件循环只处理一次
+    if(m_wakePending.testAndSetOrdered(0, 1)) {
+        QCoreApplication::postEvent(this, new QEvent(drainEventType()));
+    }
+}
+
+void MessageBoxDispatcher::drain()
+{
+    //先清除标记再取，取的过程中新加入的请求要么这次取到，要么再投递一个事件
+    m_wakePending.fetchAndStoreOrdered(0);
+    ++m_nBatches;
+
+    MessageBoxRequest request;
+    int count = 0;
+    while(count < kMaxBatch && m_queue.pop(request)) {
+        ++count;
+        //记下正在显示的请求，程序退出时提示框还没关闭也能取消
+        const int id = m_nNextId++;
+        m_showing.insert(id, request.future);
+        FramelessMessageBox::showAsync(Q_NULLPTR, request.title, request.text,
+        [id](QMessageBox::StandardButton button) {
+            if(!s_dispatcher.isDestroyed()) {
+                s_dispatcher()->finish(id, button);
+            }
+        }, request.buttons, request.icon, request.defaultButton);
+    }
+    m_nDrained += count;
+
+    if(!m_queue.isEmpty()) {
+        wake();
+    }
+}
+
+void MessageBoxDispatcher::finish(int id, QMessageBox::StandardButton button)
+{
+    QFutureInterface<QMessageBox::StandardButton> future = m_showing.take(id);
+    future.reportResult(button);
+    future.reportFinished();
+}
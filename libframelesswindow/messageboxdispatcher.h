@@ -0,0 +1,99 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * messageboxdispatcher.h
+ * 把任意线程的提示框请求转到GUI线程成批弹出。
+ *
+ */
+
+#ifndef MESSAGEBOXDISPATCHER_H
+#define MESSAGEBOXDISPATCHER_H
+
+#include "framelesswindow.h"
+#include "mpscqueue.h"
+#include <QObject>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QHash>
+
+/**
+ * @brief The MessageBoxRequest struct
+ *  一次跨线程的弹出请求
+ */
+struct MessageBoxRequest
+{
+    MessageBoxRequest()
+        : buttons(QMessageBox::Ok)
+        , defaultButton(QMessageBox::NoButton)
+        , icon(FramelessMessageBox::MSG_NOICON) {}
+
+    QString title;
+    QString text;
+    QMessageBox::StandardButtons buttons;
+    QMessageBox::StandardButton defaultButton;
+    FramelessMessageBox::IconType icon;
+    QFutureInterface<QMessageBox::StandardButton> future;
+};
+
+/**
+ * @brief The MessageBoxDispatcher class
+ *  任意线程把请求放入无锁队列，只在队列由空变为非空时向GUI线程投递一个事件；
+ *  GUI线程处理这个事件时一次取出一批请求，用showAsync弹出，结果写回各自的QFuture。
+ *  通过FramelessMessageBox::post使用
+ */
+class MessageBoxDispatcher : public QObject
+{
+public:
+    // 使用instance()，构造函数只给Q_GLOBAL_STATIC
+    MessageBoxDispatcher();
+    ~MessageBoxDispatcher();
+
+    static MessageBoxDispatcher *instance();
+
+    /**
+     * @brief post
+     * @note 线程安全。没有QApplication时不能弹出，返回已取消的QFuture；
+     *  程序退出时还没关闭的提示框也按取消结束，取消的QFuture没有result()
+     */
+    QFuture<QMessageBox::StandardButton> post(const QString &title, const QString &text,
+            QMessageBox::StandardButtons buttons, FramelessMessageBox::IconType icon,
+            QMessageBox::StandardButton defaultButton);
+
+    /**
+     * @brief canceledFuture
+     * @note 已经取消并结束的QFuture，没有result()
+     */
+    static QFuture<QMessageBox::StandardButton> canceledFuture();
+
+    /**
+     * @brief batchCount
+     * @note GUI线程取出请求的次数，只在GUI线程读取
+     */
+    qint64 batchCount() const { return m_nBatches; }
+
+    /**
+     * @brief drainedCount
+     * @note GUI线程取出的请求总数，只在GUI线程读取
+     */
+    qint64 drainedCount() const { return m_nDrained; }
+
+protected:
+    virtual bool event(QEvent *event);
+
+private:
+    void wake();
+    void drain();
+    // 提示框关闭，写回结果(GUI线程)
+    void finish(int id, QMessageBox::StandardButton button);
+
+private:
+    MpscQueue<MessageBoxRequest> m_queue;
+    QAtomicInt m_wakePending;   // 已经投递、还没处理的事件
+    QHash<int, QFutureInterface<QMessageBox::StandardButton> > m_showing; // 已弹出、还没关闭的请求，只在GUI线程访问
+    int m_nNextId;
+    qint64 m_nBatches;
+    qint64 m_nDrained;
+};
+
+#endif // MESSAGEBOXDISPATCHER_H
@@ -0,0 +1,169 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * messageboxpool.cpp
+ * 预先创建、隐藏的提示框池，FramelessMessageBox的静态show*函数重新配置后复用。
+ *
+ */
+
+#include "messageboxpool.h"
+#include "framelesswindow.h"
+#include <QCoreApplication>
+#include <QLayout>
+
+namespace {
+
+MessageBoxPool *s_pInstance = Q_NULLPTR;
+
+} // namespace
+
+MessageBoxPool *MessageBoxPool::instance()
+{
+    if(!s_pInstance) {
+        s_pInstance = new MessageBoxPool();
+        //QApplication析构时最先调用，此时提示框还可以安全删除
+        qAddPostRoutine(&MessageBoxPool::destroyInstance);
+    }
+    return s_pInstance;
+}
+
+void MessageBoxPool::destroyInstance()
+{
+    delete s_pInstance;
+    s_pInstance = Q_NULLPTR;
+}
+
+MessageBoxPool::MessageBoxPool(QObject *parent)
+    : QObject(parent)
+    , m_nPoolSize(2)
+    , m_nIdleTimeout(60000)
+{
+    m_clock.start();
+    m_trimTimer.setSingleShot(true);
+    connect(&m_trimTimer, SIGNAL(timeout()), this, SLOT(trimIdle()));
+}
+
+MessageBoxPool::~MessageBoxPool()
+{
+    clear();
+}
+
+FramelessMessageBox *MessageBoxPool::acquire(QWidget *parent, const QString &title, const QString &text,
+        QMessageBox::StandardButtons buttons,
+        QMessageBox::StandardButton defaultButton)
+{
+    FramelessMessageBox *box = Q_NULLPTR;
+    //后进先出，最近用过的提示框最可能还在缓存里
+    while(!box && !m_idleBoxes.isEmpty()) {
+        box = m_idleBoxes.takeLast().box;
+    }
+    if(!box) {
+        return new FramelessMessageBox(parent, title, text, buttons, defaultButton);
+    }
+
+    box->setParent(parent, box->windowFlags());
+    box->reconfigure(title, text, buttons, defaultButton);
+    return box;
+}
+
+void MessageBoxPool::release(FramelessMessageBox *box)
+{
+    if(!box) {
+        return;
+    }
+    if(idleCount() >= m_nPoolSize) {
+        //可能在提示框自己的finished信号中归还
+        box->deleteLater();
+        return;
+    }
+
+    //脱离原来的父窗体，父窗体销毁时不会带走池中的提示框
+    box->hide();
+    box->setParent(Q_NULLPTR, box->windowFlags());
+    //下次显示时重新按父窗体居中
+    box->setAttribute(Qt::WA_Moved, false);
+
+    IdleBox idle;
+    idle.box = box;
+    idle.idleSince = m_clock.elapsed();
+    m_idleBoxes.append(idle);
+    scheduleTrim();
+}
+
+void MessageBoxPool::setPoolSize(int size)
+{
+    m_nPoolSize = qMax(0, size);
+    while(m_idleBoxes.size() > m_nPoolSize) {
+        delete m_idleBoxes.takeFirst().box.data();
+    }
+    if(m_nPoolSize > 0) {
+        QMetaObject::invokeMethod(this, "prewarm", Qt::QueuedConnection);
+    }
+}
+
+void MessageBoxPool::setIdleTimeout(int msecs)
+{
+    m_nIdleTimeout = qMax(0, msecs);
+    scheduleTrim();
+}
+
+void MessageBoxPool::prewarm()
+{
+    while(idleCount() < m_nPoolSize) {
+        release(createBox());
+    }
+}
+
+int MessageBoxPool::idleCount() const
+{
+    int count = 0;
+    for(int i = 0; i < m_idleBoxes.size(); ++i) {
+        count += !m_idleBoxes.at(i).box.isNull();
+    }
+    return count;
+}
+
+void MessageBoxPool::clear()
+{
+    m_trimTimer.stop();
+    for(int i = 0; i < m_idleBoxes.size(); ++i) {
+        delete m_idleBoxes.at(i).box.data();
+    }
+    m_idleBoxes.clear();
+}
+
+void MessageBoxPool::trimIdle()
+{
+    const qint64 now = m_clock.elapsed();
+    //从最早归还的开始释放，至少保留一个
+    while(m_idleBoxes.size() > 1) {
+        const IdleBox &idle = m_idleBoxes.first();
+        if(!idle.box.isNull() && now - idle.idleSince < m_nIdleTimeout) {
+            break;
+        }
+        delete m_idleBoxes.takeFirst().box.data();
+    }
+    scheduleTrim();
+}
+
+FramelessMessageBox *MessageBoxPool::createBox()
+{
+    FramelessMessageBox *box = new FramelessMessageBox();
+    //提前完成样式匹配、布局计算和原生窗口创建，弹出时不再做
+    box->ensurePolished();
+    if(box->layout()) {
+        box->layout()->activate();
+    }
+    box->winId();
+    return box;
+}
+
+void MessageBoxPool::scheduleTrim()
+{
+    if(m_nIdleTimeout <= 0 || m_idleBoxes.size() <= 1) {
+        m_trimTimer.stop();
+        return;
+    }
+    const qint64 due = m_idleBoxes.first().idleSince + m_nIdleTimeout - m_clock.elapsed();
+    m_trimTimer.start(int(qBound(Q_INT64_C(0), due, Q_INT64_C(0x7fffffff))));
+}
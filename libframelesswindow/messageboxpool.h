@@ -0,0 +1,102 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * messageboxpool.h
+ * 预先创建、隐藏的提示框池，FramelessMessageBox的静态show*函数重新配置后复用。
+ *
+ */
+
+#ifndef MESSAGEBOXPOOL_H
+#define MESSAGEBOXPOOL_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMessageBox>
+
+class FramelessMessageBox;
+class QWidget;
+
+/**
+ * @brief The MessageBoxPool class
+ *  构造一个提示框需要创建窗体、标题栏、阴影、按钮、布局并解码图标，
+ *  池中保存若干已经构造并polish好的隐藏提示框，弹出时只改标题、文字、按钮和图标。
+ *  空闲超过idleTimeout的提示框会被释放，但始终保留一个。
+ *  只能在GUI线程使用
+ */
+class MessageBoxPool : public QObject
+{
+    Q_OBJECT
+public:
+    static MessageBoxPool *instance();
+
+    /**
+     * @brief acquire
+     * @note 取出一个提示框并重新配置，池为空时新建
+     */
+    FramelessMessageBox *acquire(QWidget *parent, const QString &title, const QString &text,
+                                 QMessageBox::StandardButtons buttons,
+                                 QMessageBox::StandardButton defaultButton);
+
+    /**
+     * @brief release
+     * @note 归还提示框，池已满时删除(deleteLater)
+     */
+    void release(FramelessMessageBox *box);
+
+    /**
+     * @brief setPoolSize
+     * @note 池中最多保存的空闲提示框个数，0表示不使用池。改变后在事件循环中预先创建
+     */
+    void setPoolSize(int size);
+    int poolSize() const { return m_nPoolSize; }
+
+    /**
+     * @brief setIdleTimeout
+     * @note 提示框空闲多久(毫秒)后释放，0表示不释放
+     */
+    void setIdleTimeout(int msecs);
+    int idleTimeout() const { return m_nIdleTimeout; }
+
+    /**
+     * @brief prewarm
+     * @note 立即把池填满
+     */
+    Q_INVOKABLE void prewarm();
+
+    /**
+     * @brief idleCount
+     * @note 池中当前空闲的提示框个数
+     */
+    int idleCount() const;
+
+    void clear();
+
+private slots:
+    void trimIdle();
+
+private:
+    explicit MessageBoxPool(QObject *parent = nullptr);
+    ~MessageBoxPool();
+
+    static void destroyInstance();
+    FramelessMessageBox *createBox();
+    void scheduleTrim();
+
+private:
+    struct IdleBox
+    {
+        QPointer<FramelessMessageBox> box;
+        qint64 idleSince;   // 归还时m_clock的毫秒数
+    };
+
+    QList<IdleBox> m_idleBoxes;
+    int m_nPoolSize;
+    int m_nIdleTimeout;
+    QTimer m_trimTimer;
+    QElapsedTimer m_clock;
+};
+
+#endif // MESSAGEBOXPOOL_H
@@ -0,0 +1,94 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * mpscqueue.h
+ * 无锁的多生产者单消费者队列。
+ *
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <QAtomicPointer>
+
+/**
+ * @brief The MpscQueue class
+ *  多生产者、单消费者的无锁队列(Vyukov)。任意线程可以同时push，
+ *  只能有一个线程pop。push只有一次原子交换，不会等待其他生产者或消费者。
+ *  每个元素一次堆分配；T需要可以默认构造和赋值
+ */
+template <class T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : m_pTail(new Node)
+    {
+        m_head.storeRelease(m_pTail);
+    }
+
+    ~MpscQueue()
+    {
+        T value;
+        while(pop(value)) {
+        }
+        delete m_pTail;
+    }
+
+    /**
+     * @brief push
+     * @note 任意线程调用
+     */
+    void push(const T &value)
+    {
+        Node *node = new Node;
+        node->value = value;
+        //先占据队尾，再把前一个节点链接过来；链接之前消费者看到的是队列为空
+        Node *prev = m_head.fetchAndStoreOrdered(node);
+        prev->next.storeRelease(node);
+    }
+
+    /**
+     * @brief pop
+     * @note 只能在消费者线程调用，队列为空(或最新的push还没有链接完成)时返回false
+     */
+    bool pop(T &value)
+    {
+        Node *tail = m_pTail;
+        Node *next = tail->next.loadAcquire();
+        if(!next) {
+            return false;
+        }
+        //next成为新的哑节点，取走它的值
+        value = next->value;
+        next->value = T();
+        m_pTail = next;
+        delete tail;
+        return true;
+    }
+
+    /**
+     * @brief isEmpty
+     * @note 只能在消费者线程调用
+     */
+    bool isEmpty() const
+    {
+        return m_pTail->next.loadAcquire() == Q_NULLPTR;
+    }
+
+private:
+    Q_DISABLE_COPY(MpscQueue)
+
+    struct Node
+    {
+        Node() : next(Q_NULLPTR) {}
+
+        QAtomicPointer<Node> next;
+        T value;
+    };
+
+    QAtomicPointer<Node> m_head;   // 生产者交换的队尾
+    Node *m_pTail;                 // 消费者持有的哑节点
+};
+
+#endif // MPSCQUEUE_H
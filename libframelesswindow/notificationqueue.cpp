@@ -0,0 +1,304 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * notificationqueue.cpp
+ * 合并短时间内大量提示的通知队列。
+ *
+ */
+
+#include "notificationqueue.h"
+#include "messageboxpool.h"
+#include <QPlainTextEdit>
+#include <QScrollBar>
+
+namespace {
+
+const int kCascadeOffset = 24;   // 多个提示框依次错开的距离
+
+} // namespace
+
+NotificationQueue::NotificationQueue(QWidget *parent)
+    : QObject(parent)
+    , m_pParent(parent)
+    , m_bSummaryDirty(false)
+    , m_nSummaryDropped(0)
+    , m_nSummaryTotal(0)
+    , m_pSummaryView(Q_NULLPTR)
+    , m_nVisible(0)
+    , m_nMaxVisible(3)
+    , m_nMaxSummaryEntries(1000)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(100);
+    connect(&m_flushTimer, &QTimer::timeout, this, &NotificationQueue::flush);
+}
+
+NotificationQueue::~NotificationQueue()
+{
+    clear();
+}
+
+void NotificationQueue::post(const QString &title, const QString &text, FramelessMessageBox::IconType icon)
+{
+    ++m_statistics.posted;
+
+    const QString key = entryKey(title, text, icon);
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if(it != m_entries.end()) {
+        //相同的通知只累计次数
+        ++it->count;
+        ++m_statistics.deduplicated;
+        if(it->inSummary) {
+            ++m_nSummaryTotal;
+            m_bSummaryDirty = true;
+        } else {
+            m_dirtyKeys.insert(key);
+        }
+        scheduleFlush();
+        return;
+    }
+
+    if(m_nVisible < m_nMaxVisible) {
+        Entry entry;
+        entry.title = title;
+        entry.text = text;
+        entry.icon = icon;
+        entry.count = 1;
+        m_entries.insert(key, entry);
+        m_dirtyKeys.insert(key);
+        ++m_nVisible;
+    } else if(m_summaryKeys.size() < m_nMaxSummaryEntries) {
+        Entry entry;
+        entry.title = title;
+        entry.text = text;
+        entry.icon = icon;
+        entry.count = 1;
+        entry.inSummary = true;
+        m_entries.insert(key, entry);
+        m_summaryKeys.append(key);
+        ++m_statistics.summarized;
+        ++m_nSummaryTotal;
+        m_bSummaryDirty = true;
+    } else {
+        //汇总框已满，内存不再增长
+        ++m_nSummaryDropped;
+        ++m_statistics.dropped;
+        ++m_nSummaryTotal;
+        m_bSummaryDirty = true;
+    }
+    scheduleFlush();
+}
+
+void NotificationQueue::setMaxVisible(int count)
+{
+    m_nMaxVisible = qMax(1, count);
+}
+
+void NotificationQueue::setMaxSummaryEntries(int count)
+{
+    m_nMaxSummaryEntries = qMax(0, count);
+}
+
+void NotificationQueue::setCoalesceInterval(int msecs)
+{
+    m_flushTimer.setInterval(qMax(0, msecs));
+}
+
+void NotificationQueue::flush()
+{
+    m_flushTimer.stop();
+    ++m_statistics.flushes;
+
+    QSet<QString> dirtyKeys;
+    dirtyKeys.swap(m_dirtyKeys);
+    for(QSet<QString>::const_iterator key = dirtyKeys.constBegin(); key != dirtyKeys.constEnd(); ++key) {
+        QHash<QString, Entry>::iterator it = m_entries.find(*key);
+        if(it != m_entries.end() && !it->inSummary) {
+            showEntry(*key, *it);
+        }
+    }
+
+    if(m_bSummaryDirty) {
+        updateSummary();
+    }
+}
+
+void NotificationQueue::clear()
+{
+    m_flushTimer.stop();
+
+    QList<QPointer<FramelessMessageBox> > boxes;
+    for(QHash<QString, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+        if(it->box) {
+            disconnect(it->finishedConnection);
+            boxes.append(it->box);
+        }
+    }
+    m_entries.clear();
+    m_dirtyKeys.clear();
+    m_summaryKeys.clear();
+    m_bSummaryDirty = false;
+    m_nSummaryDropped = 0;
+    m_nSummaryTotal = 0;
+    m_nVisible = 0;
+
+    for(int i = 0; i < boxes.size(); ++i) {
+        MessageBoxPool::instance()->release(boxes.at(i).data());
+    }
+
+    if(m_pSummaryBox) {
+        disconnect(m_pSummaryBox, Q_NULLPTR, this, Q_NULLPTR);
+        m_pSummaryBox->hide();
+        m_pSummaryBox->deleteLater();
+    }
+    m_pSummaryView = Q_NULLPTR;
+}
+
+QString NotificationQueue::entryKey(const QString &title, const QString &text, FramelessMessageBox::IconType icon)
+{
+    const QChar separator(0x1f);
+    return QString::number(int(icon)) + separator + title + separator + text;
+}
+
+void NotificationQueue::scheduleFlush()
+{
+    if(!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void NotificationQueue::showEntry(const QString &key, Entry &entry)
+{
+    //通知的文字里可能有%1等，必须一次arg替换
+    const QString text = (entry.count > 1) ? tr("%1\n(%2 times)").arg(entry.text, QString::number(entry.count))
+                         : entry.text;
+
+    if(entry.box) {
+        entry.box->setText(text);
+        return;
+    }
+
+    FramelessMessageBox *pMsgBox = MessageBoxPool::instance()->acquire(m_pParent, entry.title, text,
+                                   QMessageBox::Ok, QMessageBox::Ok);
+    pMsgBox->setIconType(entry.icon);
+    pMsgBox->setWindowModality(Qt::NonModal);
+    entry.finishedConnection = connect(pMsgBox, &QDialog::finished, this, [this, key](int) {
+        onBoxFinished(key);
+    });
+    entry.box = pMsgBox;
+
+    pMsgBox->show();
+    //同时显示的提示框依次错开，不完全重叠
+    const int slot = int(m_statistics.boxesShown % m_nMaxVisible);
+    pMsgBox->move(pMsgBox->pos() + QPoint(kCascadeOffset, kCascadeOffset) * slot);
+    ++m_statistics.boxesShown;
+}
+
+void NotificationQueue::onBoxFinished(const QString &key)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if(it == m_entries.end()) {
+        return;
+    }
+
+    disconnect(it->finishedConnection);
+    QPointer<FramelessMessageBox> guard(it->box);
+    m_entries.erase(it);
+    m_dirtyKeys.remove(key);
+    --m_nVisible;
+    promoteSummaryEntry();
+
+    //还在提示框自己的finished信号中，下一次事件循环再归还
+    QTimer::singleShot(0, MessageBoxPool::instance(), [guard]() {
+        MessageBoxPool::instance()->release(guard.data());
+    });
+}
+
+void NotificationQueue::promoteSummaryEntry()
+{
+    if(m_summaryKeys.isEmpty() || m_nVisible >= m_nMaxVisible) {
+        return;
+    }
+
+    //空出的位置给汇总框中最早的通知，突发期间单独的提示框能补满
+    const QString key = m_summaryKeys.takeFirst();
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if(it == m_entries.end()) {
+        return;
+    }
+    it->inSummary = false;
+    m_nSummaryTotal -= it->count;
+    m_bSummaryDirty = true;
+    m_dirtyKeys.insert(key);
+    ++m_nVisible;
+    ++m_statistics.promoted;
+    scheduleFlush();
+}
+
+void NotificationQueue::updateSummary()
+{
+    m_bSummaryDirty = false;
+    if(m_summaryKeys.isEmpty() && m_nSummaryDropped == 0) {
+        //汇总的通知都已单独显示，汇总框没有内容了
+        if(m_pSummaryBox) {
+            disconnect(m_pSummaryBox, Q_NULLPTR, this, Q_NULLPTR);
+            m_pSummaryBox->hide();
+            onSummaryFinished();
+        }
+        return;
+    }
+
+    if(!m_pSummaryBox) {
+        FramelessMessageBox *pMsgBox = new FramelessMessageBox(m_pParent, QString(), QString(),
+                QMessageBox::Ok, QMessageBox::Ok);
+        pMsgBox->setIconType(FramelessMessageBox::MSG_WARNNING);
+        pMsgBox->setWidgetResizable(true);
+
+        m_pSummaryView = new QPlainTextEdit(pMsgBox);
+        m_pSummaryView->setReadOnly(true);
+        m_pSummaryView->setLineWrapMode(QPlainTextEdit::NoWrap);
+        pMsgBox->addWidget(m_pSummaryView);
+        pMsgBox->resize(480, 320);
+
+        connect(pMsgBox, &QDialog::finished, this, &NotificationQueue::onSummaryFinished);
+        m_pSummaryBox = pMsgBox;
+        pMsgBox->show();
+    }
+
+    m_pSummaryBox->setTitle(tr("%1 more notifications").arg(m_nSummaryTotal));
+
+    //条数有上限，整段重建比逐行修改简单
+    QString lines;
+    for(int i = 0; i < m_summaryKeys.size(); ++i) {
+        QHash<QString, Entry>::const_iterator it = m_entries.constFind(m_summaryKeys.at(i));
+        if(it == m_entries.constEnd()) {
+            continue;
+        }
+        lines += QStringLiteral("[%1] %2: %3\n").arg(QString::number(it->count), it->title, it->text.simplified());
+    }
+    if(m_nSummaryDropped > 0) {
+        lines += tr("... and %1 more not listed").arg(m_nSummaryDropped);
+    }
+
+    QScrollBar *pScrollBar = m_pSummaryView->verticalScrollBar();
+    const int value = pScrollBar->value();
+    m_pSummaryView->setPlainText(lines);
+    pScrollBar->setValue(value);
+}
+
+void NotificationQueue::onSummaryFinished()
+{
+    for(int i = 0; i < m_summaryKeys.size(); ++i) {
+        m_entries.remove(m_summaryKeys.at(i));
+    }
+    m_summaryKeys.clear();
+    m_nSummaryDropped = 0;
+    m_nSummaryTotal = 0;
+    m_bSummaryDirty = false;
+
+    if(m_pSummaryBox) {
+        m_pSummaryBox->deleteLater();
+    }
+    m_pSummaryBox = Q_NULLPTR;
+    m_pSummaryView = Q_NULLPTR;
+}
@@ -0,0 +1,148 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * notificationqueue.h
+ * 合并短时间内大量提示的通知队列。
+ *
+ */
+
+#ifndef NOTIFICATIONQUEUE_H
+#define NOTIFICATIONQUEUE_H
+
+#include "framelesswindow.h"
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QPointer>
+#include <QTimer>
+
+class QPlainTextEdit;
+
+/**
+ * @brief The NotificationStatistics struct
+ *  通知队列统计，用于确认合并、丢弃的数量
+ */
+struct NotificationStatistics
+{
+    NotificationStatistics()
+        : posted(0), deduplicated(0), summarized(0), dropped(0), promoted(0), boxesShown(0), flushes(0) {}
+
+    qint64 posted;        //post调用次数
+    qint64 deduplicated;  //与已有通知相同、只增加计数的次数
+    qint64 summarized;    //放入汇总框的不同通知数
+    qint64 dropped;       //汇总框已满、只计数不保存的次数
+    qint64 promoted;      //单独的提示框关闭后从汇总框移出、单独显示的通知数
+    qint64 boxesShown;    //弹出的单独提示框个数
+    qint64 flushes;       //刷新界面的次数
+};
+
+/**
+ * @brief The NotificationQueue class
+ *  在FramelessMessageBox之上合并通知：标题、文字、图标都相同的通知只显示一个提示框并累计次数；
+ *  同时显示的提示框个数有上限，超出的通知放入一个可滚动的汇总框；单独的提示框关闭后，
+ *  汇总框中最早的通知移出来单独显示。
+ *  post只修改内存中的表，界面按合并间隔统一刷新，突发的大量通知不会逐个构造窗体。
+ *  提示框不是模态的，不会阻塞调用方。只能在GUI线程使用
+ */
+class NotificationQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NotificationQueue(QWidget *parent = nullptr);
+    ~NotificationQueue();
+
+    /**
+     * @brief post
+     * @note 添加一条通知，立即返回
+     */
+    void post(const QString &title, const QString &text,
+              FramelessMessageBox::IconType icon = FramelessMessageBox::MSG_ERROR);
+
+    /**
+     * @brief setMaxVisible
+     * @note 同时显示的单独提示框个数(不含汇总框)，默认3
+     */
+    void setMaxVisible(int count);
+    int maxVisible() const { return m_nMaxVisible; }
+
+    /**
+     * @brief setMaxSummaryEntries
+     * @note 汇总框最多保存的不同通知条数，超出后只计数，默认1000
+     */
+    void setMaxSummaryEntries(int count);
+    int maxSummaryEntries() const { return m_nMaxSummaryEntries; }
+
+    /**
+     * @brief setCoalesceInterval
+     * @note 界面刷新的间隔(毫秒)，期间的通知合并为一次刷新，默认100
+     */
+    void setCoalesceInterval(int msecs);
+    int coalesceInterval() const { return m_flushTimer.interval(); }
+
+    /**
+     * @brief visibleCount
+     * @note 当前单独显示(或等待显示)的通知个数
+     */
+    int visibleCount() const { return m_nVisible; }
+
+    /**
+     * @brief pendingCount
+     * @note 队列中保存的不同通知个数，包括汇总框中的
+     */
+    int pendingCount() const { return m_entries.size(); }
+
+    NotificationStatistics statistics() const { return m_statistics; }
+
+    /**
+     * @brief flush
+     * @note 立即刷新界面，不等合并间隔
+     */
+    void flush();
+
+    /**
+     * @brief clear
+     * @note 关闭所有提示框和汇总框，清空队列
+     */
+    void clear();
+
+private:
+    struct Entry
+    {
+        Entry() : icon(FramelessMessageBox::MSG_NOICON), count(0), inSummary(false) {}
+
+        QString title;
+        QString text;
+        FramelessMessageBox::IconType icon;
+        int count;                            //累计次数
+        bool inSummary;                       //是否放在汇总框中
+        QPointer<FramelessMessageBox> box;    //单独显示的提示框
+        QMetaObject::Connection finishedConnection;
+    };
+
+    static QString entryKey(const QString &title, const QString &text, FramelessMessageBox::IconType icon);
+    void scheduleFlush();
+    void showEntry(const QString &key, Entry &entry);
+    void onBoxFinished(const QString &key);
+    void promoteSummaryEntry();
+    void updateSummary();
+    void onSummaryFinished();
+
+private:
+    QPointer<QWidget> m_pParent;
+    QHash<QString, Entry> m_entries;
+    QSet<QString> m_dirtyKeys;         //计数改变、需要刷新的单独提示框
+    QStringList m_summaryKeys;         //汇总框中的通知，按到达顺序
+    bool m_bSummaryDirty;
+    qint64 m_nSummaryDropped;          //汇总框满后未保存的次数
+    qint64 m_nSummaryTotal;            //进入汇总框的通知总次数
+    QPointer<FramelessMessageBox> m_pSummaryBox;
+    QPlainTextEdit *m_pSummaryView;
+    int m_nVisible;
+    int m_nMaxVisible;
+    int m_nMaxSummaryEntries;
+    QTimer m_flushTimer;
+    NotificationStatistics m_statistics;
+};
+
+#endif // NOTIFICATIONQUEUE_H
@@ -0,0 +1,149 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * roundedmask.cpp
+ * 直接由圆角的扫描线生成窗口遮罩。
+ *
+ */
+
+#include "roundedmask.h"
+#include <QCache>
+#include <QVector>
+#include <QtMath>
+#include <QGuiApplication>
+
+#if defined(Q_OS_WIN)
+#  include <qt_windows.h>
+#  include <dwmapi.h>
+#elif defined(FRAMELESS_HAS_X11EXTRAS)
+#  include <QX11Info>
+#endif
+
+namespace {
+
+struct RoundedMaskKey
+{
+    QSize size;
+    int   radius;
+    int   dpr;   // 设备像素比 * 100
+
+    bool operator==(const RoundedMaskKey &other) const
+    {
+        return size == other.size && radius == other.radius && dpr == other.dpr;
+    }
+};
+
+inline uint qHash(const RoundedMaskKey &key, uint seed = 0)
+{
+    return ::qHash(key.size.width(), seed) ^ ::qHash(key.size.height(), seed + 1)
+           ^ ::qHash(key.radius, seed + 2) ^ ::qHash(key.dpr, seed + 3);
+}
+
+typedef QCache<RoundedMaskKey, QRegion> RoundedMaskCache;
+Q_GLOBAL_STATIC_WITH_ARGS(RoundedMaskCache, s_maskCache, (32))
+
+/*
+ * 圆角第y行(从圆角顶部算起)两侧需要挖掉的宽度。
+ * 高分屏上一行逻辑像素包含多行物理像素，取其中可见最宽的一行，避免切掉抗锯齿的边缘。
+ */
+int cornerInset(int y, int radius, qreal dpr)
+{
+    const int samples = qMax(1, qCeil(dpr));
+    qreal inset = radius;
+    for(int k = 0; k < samples; ++k) {
+        const qreal dy = radius - (y + (k + 0.5) / samples);
+        inset = qMin(inset, radius - qSqrt(qMax(qreal(0), qreal(radius) * radius - dy * dy)));
+    }
+    return qRound(inset);
+}
+
+QRegion buildRegion(const QSize &size, int radius, qreal dpr)
+{
+    const int w = size.width();
+    const int h = size.height();
+
+    QVector<int> insets(radius);
+    for(int y = 0; y < radius; ++y) {
+        insets[y] = cornerInset(y, radius, dpr);
+    }
+
+    //按Y-X排序的条带，相同宽度的相邻行合并为一个矩形
+    QVector<QRect> rects;
+    rects.reserve(radius * 2 + 1);
+
+    int start = 0;
+    for(int y = 1; y <= radius; ++y) {
+        if(y == radius || insets[y] != insets[start]) {
+            rects.append(QRect(insets[start], start, w - 2 * insets[start], y - start));
+            start = y;
+        }
+    }
+
+    if(h > 2 * radius) {
+        rects.append(QRect(0, radius, w, h - 2 * radius));
+    }
+
+    int end = radius;
+    for(int y = radius - 1; y >= -1; --y) {
+        if(y == -1 || insets[y] != insets[end - 1]) {
+            const int inset = insets[end - 1];
+            rects.append(QRect(inset, h - end, w - 2 * inset, end - y - 1));
+            end = y + 1;
+        }
+    }
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+} // namespace
+
+QRegion RoundedMask::region(const QSize &size, int radius, qreal dpr)
+{
+    radius = qMin(radius, qMin(size.width(), size.height()) / 2);
+    if(radius <= 0 || size.isEmpty()) {
+        return QRegion(QRect(QPoint(0, 0), size));
+    }
+
+    RoundedMaskKey key;
+    key.size = size;
+    key.radius = radius;
+    key.dpr = qRound(dpr * 100);
+
+    if(QRegion *cached = s_maskCache()->object(key)) {
+        return *cached;
+    }
+
+    QRegion *region = new QRegion(buildRegion(size, radius, dpr));
+    const QRegion result = *region;
+    s_maskCache()->insert(key, region);
+    return result;
+}
+
+int RoundedMask::cachedCount()
+{
+    return s_maskCache()->count();
+}
+
+void RoundedMask::setCacheCapacity(int count)
+{
+    s_maskCache()->setMaxCost(qMax(1, count));
+}
+
+bool RoundedMask::compositorRunning()
+{
+#if defined(Q_OS_WIN)
+    //Windows 8起DWM合成总是开启，Windows 7可以关闭
+    BOOL enabled = FALSE;
+    return SUCCEEDED(DwmIsCompositionEnabled(&enabled)) && enabled;
+#elif defined(FRAMELESS_HAS_X11EXTRAS)
+    if(QX11Info::isPlatformX11()) {
+        return QX11Info::isCompositingManagerRunning();
+    }
+    return true;
+#else
+    //没有x11extras时无法查询X11的合成管理器，按没有处理，圆角用遮罩
+    return QGuiApplication::platformName() != QLatin1String("xcb");
+#endif
+}
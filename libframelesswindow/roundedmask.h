@@ -0,0 +1,54 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * roundedmask.h
+ * 直接由圆角的扫描线生成窗口遮罩，按(大小, 半径, 设备像素比)缓存。
+ *
+ */
+
+#ifndef ROUNDEDMASK_H
+#define ROUNDEDMASK_H
+
+#include <QRegion>
+#include <QSize>
+
+/**
+ * @brief The RoundedMask class
+ *  圆角矩形遮罩。不再生成整窗大小的QBitmap再光栅化，
+ *  四个角逐行计算可见宽度，中间部分是一个矩形。只能在GUI线程中使用。
+ */
+class RoundedMask
+{
+public:
+    /**
+     * @brief region
+     * @note 取得圆角遮罩，radius小于等于0时返回整个矩形
+     * @param size 窗口大小
+     * @param radius 圆角半径
+     * @param dpr 设备像素比，高分屏上按物理像素行采样圆弧
+     * @return
+     */
+    static QRegion region(const QSize &size, int radius, qreal dpr = 1.0);
+
+    /**
+     * @brief cachedCount
+     * @note 缓存中遮罩的数量
+     */
+    static int cachedCount();
+
+    /**
+     * @brief setCacheCapacity
+     * @note 设置最多缓存多少个遮罩，默认32个
+     */
+    static void setCacheCapacity(int count);
+
+    /**
+     * @brief compositorRunning
+     * @note 桌面是否有合成器，没有时窗口的per-pixel alpha不生效，圆角需要遮罩。
+     *  X11上查询合成管理器(需要x11extras模块，没有时按没有合成器处理)，
+     *  Windows上查询DWM合成，其他平台总是有合成器。每次调用都会查询，调用方自行缓存
+     */
+    static bool compositorRunning();
+};
+
+#endif // ROUNDEDMASK_H
@@ -0,0 +1,103 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * screentracker.cpp
+ * 跟踪窗体当前所在的屏幕，缓存该屏幕的可用区域。
+ *
+ */
+
+#include "screentracker.h"
+#include <QWidget>
+#include <QWindow>
+#include <QScreen>
+#include <QEvent>
+#include <QGuiApplication>
+
+ScreenTracker::ScreenTracker(QWidget *window)
+    : QObject(window)
+    , m_pWidget(window)
+{
+    m_pWidget->installEventFilter(this);
+
+    //还没有创建原生窗口时，按窗体中心所在的屏幕
+    QScreen *pScreen = QGuiApplication::screenAt(m_pWidget->geometry().center());
+    onScreenChanged(pScreen ? pScreen : QGuiApplication::primaryScreen());
+    attachWindow();
+}
+
+QScreen *ScreenTracker::screen() const
+{
+    return m_pScreen;
+}
+
+QRect ScreenTracker::availableGeometry() const
+{
+    return m_availableGeometry;
+}
+
+ScreenTracker *ScreenTracker::find(QWidget *window)
+{
+    if(window == nullptr) {
+        return nullptr;
+    }
+    return window->findChild<ScreenTracker *>(QString(), Qt::FindDirectChildrenOnly);
+}
+
+bool ScreenTracker::eventFilter(QObject *obj, QEvent *event)
+{
+    switch(event->type()) {
+    case QEvent::WinIdChange:
+    case QEvent::Show:
+        attachWindow();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(obj, event);
+}
+
+void ScreenTracker::attachWindow()
+{
+    QWindow *pWindow = m_pWidget->windowHandle();
+    if(pWindow == nullptr || pWindow == m_pWindow) {
+        return;
+    }
+
+    if(m_pWindow) {
+        disconnect(m_pWindow, &QWindow::screenChanged, this, &ScreenTracker::onScreenChanged);
+    }
+    m_pWindow = pWindow;
+    connect(pWindow, &QWindow::screenChanged, this, &ScreenTracker::onScreenChanged);
+    onScreenChanged(pWindow->screen());
+}
+
+void ScreenTracker::onScreenChanged(QScreen *screen)
+{
+    if(screen == m_pScreen) {
+        return;
+    }
+
+    if(m_pScreen) {
+        disconnect(m_pScreen, &QScreen::availableGeometryChanged, this, &ScreenTracker::onAvailableGeometryChanged);
+    }
+
+    m_pScreen = screen;
+    if(screen == nullptr) {
+        return;
+    }
+
+    connect(screen, &QScreen::availableGeometryChanged, this, &ScreenTracker::onAvailableGeometryChanged);
+    m_availableGeometry = screen->availableGeometry();
+    emit screenChanged(screen);
+    emit availableGeometryChanged(m_availableGeometry);
+}
+
+void ScreenTracker::onAvailableGeometryChanged(const QRect &rect)
+{
+    if(rect == m_availableGeometry) {
+        return;
+    }
+
+    m_availableGeometry = rect;
+    emit availableGeometryChanged(rect);
+}
@@ -0,0 +1,78 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * screentracker.h
+ * 跟踪窗体当前所在的屏幕，缓存该屏幕的可用区域。
+ *
+ */
+
+#ifndef SCREENTRACKER_H
+#define SCREENTRACKER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QRect>
+
+class QWidget;
+class QWindow;
+class QScreen;
+
+/**
+ * @brief The ScreenTracker class
+ *  跟踪窗体所在的QScreen，只在屏幕切换或QScreen::availableGeometryChanged时刷新可用区域，
+ *  最大化判断和最大化后的大小都按窗体所在的屏幕计算
+ */
+class ScreenTracker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScreenTracker(QWidget *window);
+
+    /**
+     * @brief screen
+     *  窗体当前所在的屏幕
+     * @return
+     *  QScreen *
+     */
+    QScreen *screen() const;
+
+    /**
+     * @brief availableGeometry
+     *  窗体所在屏幕的可用区域(缓存)
+     * @return
+     *  QRect
+     */
+    QRect availableGeometry() const;
+
+    /**
+     * @brief find
+     *  查找窗体的ScreenTracker
+     * @param window
+     *  QWidget *
+     * @return
+     *  ScreenTracker * 没有时返回nullptr
+     */
+    static ScreenTracker *find(QWidget *window);
+
+signals:
+    void screenChanged(QScreen *screen);
+    void availableGeometryChanged(const QRect &rect);
+
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event);
+
+private slots:
+    void onScreenChanged(QScreen *screen);
+    void onAvailableGeometryChanged(const QRect &rect);
+
+private:
+    void attachWindow();
+
+private:
+    QWidget *m_pWidget;
+    QPointer<QWindow> m_pWindow;
+    QPointer<QScreen> m_pScreen;
+    QRect m_availableGeometry;
+};
+
+#endif // SCREENTRACKER_H
@@ -0,0 +1,391 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * shadowgenerator.cpp
+ * 程序化生成窗口阴影，可分离的盒式/高斯模糊，带SSE2/AVX2实现。
+ *
+ */
+
+#include "shadowgenerator.h"
+#include <QPainter>
+#include <QPixmapCache>
+#include <QVector>
+#include <QtMath>
+
+#include <private/qsimd_p.h>
+
+//SSE2是x86-64的基线，编译时决定；AVX2按函数单独编译，运行时检测CPU后才调用
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define FRAMELESS_BLUR_SSE2
+#endif
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+#  include <immintrin.h>
+#  define FRAMELESS_BLUR_AVX2
+#endif
+
+namespace {
+
+/*
+ * 垂直方向的滑动窗口累加。一行ARGB32_Premultiplied像素按字节看待，
+ * 每个字节(通道)各自独立累加，所以三种实现只需要处理uchar与qint32之间的加、减、存。
+ * 存回时三种实现都是加0.5后截断，结果逐位相同
+ */
+template <bool Add>
+inline void accumulateRowScalar(qint32 *sums, const uchar *row, int begin, int n)
+{
+    for(int i = begin; i < n; ++i) {
+        if(Add) {
+            sums[i] += row[i];
+        } else {
+            sums[i] -= row[i];
+        }
+    }
+}
+
+inline void storeRowScalar(uchar *row, const qint32 *sums, int begin, int n, float scale)
+{
+    for(int i = begin; i < n; ++i) {
+        row[i] = uchar(sums[i] * scale + 0.5f);
+    }
+}
+
+#if defined(FRAMELESS_BLUR_AVX2)
+
+template <bool Add>
+QT_FUNCTION_TARGET(AVX2)
+void accumulateRowAvx2(qint32 *sums, const uchar *row, int n)
+{
+    int i = 0;
+    for(; i + 16 <= n; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        __m256i *s = reinterpret_cast<__m256i *>(sums + i);
+        const __m256i lo = _mm256_cvtepu8_epi32(bytes);
+        const __m256i hi = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+        if(Add) {
+            _mm256_storeu_si256(s + 0, _mm256_add_epi32(_mm256_loadu_si256(s + 0), lo));
+            _mm256_storeu_si256(s + 1, _mm256_add_epi32(_mm256_loadu_si256(s + 1), hi));
+        } else {
+            _mm256_storeu_si256(s + 0, _mm256_sub_epi32(_mm256_loadu_si256(s + 0), lo));
+            _mm256_storeu_si256(s + 1, _mm256_sub_epi32(_mm256_loadu_si256(s + 1), hi));
+        }
+    }
+    accumulateRowScalar<Add>(sums, row, i, n);
+}
+
+QT_FUNCTION_TARGET(AVX2)
+void storeRowAvx2(uchar *row, const qint32 *sums, int n, float scale)
+{
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    int i = 0;
+    for(; i + 16 <= n; i += 16) {
+        const __m256i *p = reinterpret_cast<const __m256i *>(sums + i);
+        //与标量实现相同，先乘再加0.5，截断取整(不能用cvtps的就近舍入)
+        const __m256i a = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(p + 0)), s), half));
+        const __m256i b = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(p + 1)), s), half));
+        //packs按128位通道交错，重新排回 a0..a7 b0..b7
+        const __m256i ab = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(ab), _mm256_extracti128_si256(ab, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), bytes);
+    }
+    storeRowScalar(row, sums, i, n, scale);
+}
+
+#endif
+
+#if defined(FRAMELESS_BLUR_SSE2)
+
+template <bool Add>
+void accumulateRowSse2(qint32 *sums, const uchar *row, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for(; i + 16 <= n; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i));
+        const __m128i lo16 = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i hi16 = _mm_unpackhi_epi8(bytes, zero);
+        const __m128i v[4] = {
+            _mm_unpacklo_epi16(lo16, zero), _mm_unpackhi_epi16(lo16, zero),
+            _mm_unpacklo_epi16(hi16, zero), _mm_unpackhi_epi16(hi16, zero)
+        };
+        __m128i *s = reinterpret_cast<__m128i *>(sums + i);
+        for(int k = 0; k < 4; ++k) {
+            const __m128i old = _mm_loadu_si128(s + k);
+            _mm_storeu_si128(s + k, Add ? _mm_add_epi32(old, v[k]) : _mm_sub_epi32(old, v[k]));
+        }
+    }
+    accumulateRowScalar<Add>(sums, row, i, n);
+}
+
+void storeRowSse2(uchar *row, const qint32 *sums, int n, float scale)
+{
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 half = _mm_set1_ps(0.5f);
+    int i = 0;
+    for(; i + 16 <= n; i += 16) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(sums + i);
+        const __m128i a = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(p + 0)), s), half));
+        const __m128i b = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(p + 1)), s), half));
+        const __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(p + 2)), s), half));
+        const __m128i d = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(p + 3)), s), half));
+        const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), bytes);
+    }
+    storeRowScalar(row, sums, i, n, scale);
+}
+
+#endif
+
+//AutoKernel和CPU不支持的实现都换成可用的最快实现
+ShadowGenerator::BlurKernel resolveKernel(ShadowGenerator::BlurKernel kernel)
+{
+    if(kernel != ShadowGenerator::AutoKernel && ShadowGenerator::hasKernel(kernel)) {
+        return kernel;
+    }
+    if(ShadowGenerator::hasKernel(ShadowGenerator::Avx2Kernel)) {
+        return ShadowGenerator::Avx2Kernel;
+    }
+    if(ShadowGenerator::hasKernel(ShadowGenerator::Sse2Kernel)) {
+        return ShadowGenerator::Sse2Kernel;
+    }
+    return ShadowGenerator::ScalarKernel;
+}
+
+template <bool Add>
+inline void accumulateRow(qint32 *sums, const uchar *row, int n, ShadowGenerator::BlurKernel kernel)
+{
+    switch(kernel) {
+#if defined(FRAMELESS_BLUR_AVX2)
+    case ShadowGenerator::Avx2Kernel:
+        accumulateRowAvx2<Add>(sums, row, n);
+        break;
+#endif
+#if defined(FRAMELESS_BLUR_SSE2)
+    case ShadowGenerator::Sse2Kernel:
+        accumulateRowSse2<Add>(sums, row, n);
+        break;
+#endif
+    default:
+        accumulateRowScalar<Add>(sums, row, 0, n);
+        break;
+    }
+}
+
+inline void storeRow(uchar *row, const qint32 *sums, int n, float scale, ShadowGenerator::BlurKernel kernel)
+{
+    switch(kernel) {
+#if defined(FRAMELESS_BLUR_AVX2)
+    case ShadowGenerator::Avx2Kernel:
+        storeRowAvx2(row, sums, n, scale);
+        break;
+#endif
+#if defined(FRAMELESS_BLUR_SSE2)
+    case ShadowGenerator::Sse2Kernel:
+        storeRowSse2(row, sums, n, scale);
+        break;
+#endif
+    default:
+        storeRowScalar(row, sums, 0, n, scale);
+        break;
+    }
+}
+
+/*
+ * 垂直盒式模糊，窗口为[y-radius, y+radius]。
+ * 上方越界按透明处理，下方越界重复最后一行，这样角和边都可以只模糊一小块：
+ * 向内(右、下)的窗口区域等效于无限延伸。
+ */
+void boxBlurVertical(const QImage &src, QImage &dst, int radius, ShadowGenerator::BlurKernel kernel)
+{
+    const int h = src.height();
+    const int n = src.width() * 4;
+    const float scale = 1.0f / float(2 * radius + 1);
+    QVector<qint32> sums(n, 0);
+    qint32 *s = sums.data();
+
+    for(int j = 0; j < radius; ++j) {
+        accumulateRow<true>(s, src.constScanLine(qMin(j, h - 1)), n, kernel);
+    }
+
+    for(int y = 0; y < h; ++y) {
+        accumulateRow<true>(s, src.constScanLine(qMin(y + radius, h - 1)), n, kernel);
+        storeRow(dst.scanLine(y), s, n, scale, kernel);
+        if(y - radius >= 0) {
+            accumulateRow<false>(s, src.constScanLine(y - radius), n, kernel);
+        }
+    }
+}
+
+QImage transposed(const QImage &image)
+{
+    QImage result(image.height(), image.width(), image.format());
+    for(int y = 0; y < image.height(); ++y) {
+        const quint32 *line = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        for(int x = 0; x < image.width(); ++x) {
+            reinterpret_cast<quint32 *>(result.scanLine(x))[y] = line[x];
+        }
+    }
+    return result;
+}
+
+void gaussianBlurVertical(QImage &image, const int radii[3], ShadowGenerator::BlurKernel kernel)
+{
+    QImage buffer(image.size(), image.format());
+    for(int i = 0; i < 3; ++i) {
+        if(radii[i] <= 0) {
+            continue;
+        }
+        boxBlurVertical(image, buffer, radii[i], kernel);
+        qSwap(image, buffer);
+    }
+}
+
+//三次盒式模糊近似高斯模糊时每次的半径
+void boxesForGauss(qreal sigma, int radii[3])
+{
+    const int n = 3;
+    const qreal wIdeal = qSqrt(12 * sigma * sigma / n + 1);
+    int wl = qFloor(wIdeal);
+    if(wl % 2 == 0) {
+        --wl;
+    }
+    const int wu = wl + 2;
+    const qreal mIdeal = (12 * sigma * sigma - n * wl * wl - 4 * n * wl - 3 * n) / (-4 * wl - 4);
+    const int m = qRound(mIdeal);
+    for(int i = 0; i < n; ++i) {
+        radii[i] = ((i < m ? wl : wu) - 1) / 2;
+    }
+}
+
+} // namespace
+
+void ShadowGenerator::gaussianBlur(QImage &image, qreal sigma, bool horizontal, bool vertical, BlurKernel kernel)
+{
+    if(image.isNull() || sigma <= 0) {
+        return;
+    }
+    if(image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    int radii[3];
+    boxesForGauss(sigma, radii);
+    kernel = resolveKernel(kernel);
+
+    if(vertical) {
+        gaussianBlurVertical(image, radii, kernel);
+    }
+    if(horizontal) {
+        //转置后按垂直方向处理，内存访问保持连续
+        QImage t = transposed(image);
+        gaussianBlurVertical(t, radii, kernel);
+        image = transposed(t);
+    }
+}
+
+QImage ShadowGenerator::generate(int radius, const QColor &color, int spread, BlurKernel kernel)
+{
+    radius = qMax(0, radius);
+    spread = qMax(0, spread);
+    const int extent = radius + spread;
+    if(extent <= 0) {
+        return QImage();
+    }
+
+    const qreal sigma = radius / 3.0;
+    const QRgb fill = qPremultiply(color.rgba());
+    const int n = extent * 2;
+
+    //一个角：窗口左上角位于(extent, extent)，向外扩展spread后开始填充
+    QImage corner(n, n, QImage::Format_ARGB32_Premultiplied);
+    corner.fill(Qt::transparent);
+    for(int y = radius; y < n; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(corner.scanLine(y));
+        for(int x = radius; x < n; ++x) {
+            line[x] = fill;
+        }
+    }
+    gaussianBlur(corner, sigma, true, true, kernel);
+
+    //一条1像素宽的边，只需要垂直方向模糊
+    QImage edge(1, n, QImage::Format_ARGB32_Premultiplied);
+    edge.fill(Qt::transparent);
+    for(int y = radius; y < n; ++y) {
+        reinterpret_cast<QRgb *>(edge.scanLine(y))[0] = fill;
+    }
+    gaussianBlur(edge, sigma, false, true, kernel);
+
+    //镜像角、拉伸边，拼成(2 * extent + 1)的九宫格，中间1像素是客户区，保持透明
+    const int size = n + 1;
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    const QImage topLeft = corner.copy(0, 0, extent, extent);
+    {
+        QPainter painter(&image);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(0, 0, topLeft);
+        painter.drawImage(extent + 1, 0, topLeft.mirrored(true, false));
+        painter.drawImage(0, extent + 1, topLeft.mirrored(false, true));
+        painter.drawImage(extent + 1, extent + 1, topLeft.mirrored(true, true));
+    }
+
+    QRgb *middle = reinterpret_cast<QRgb *>(image.scanLine(extent));
+    for(int i = 0; i < extent; ++i) {
+        const QRgb v = reinterpret_cast<const QRgb *>(edge.constScanLine(i))[0];
+        reinterpret_cast<QRgb *>(image.scanLine(i))[extent] = v;             //上
+        reinterpret_cast<QRgb *>(image.scanLine(size - 1 - i))[extent] = v;  //下
+        middle[i] = v;                                                        //左
+        middle[size - 1 - i] = v;                                             //右
+    }
+
+    return image;
+}
+
+QPixmap ShadowGenerator::pixmap(int radius, const QColor &color, int spread)
+{
+    const QString key = cacheKey(radius, color, spread);
+    QPixmap result;
+    if(!QPixmapCache::find(key, &result)) {
+        result = QPixmap::fromImage(generate(radius, color, spread));
+        QPixmapCache::insert(key, result);
+    }
+    return result;
+}
+
+QString ShadowGenerator::cacheKey(int radius, const QColor &color, int spread)
+{
+    return QStringLiteral("frameless-shadow:%1:%2:%3").arg(radius).arg(spread).arg(color.rgba(), 8, 16, QLatin1Char('0'));
+}
+
+bool ShadowGenerator::hasKernel(BlurKernel kernel)
+{
+    switch(kernel) {
+    case AutoKernel:
+    case ScalarKernel:
+        return true;
+#if defined(FRAMELESS_BLUR_SSE2)
+    case Sse2Kernel:
+        return qCpuHasFeature(SSE2);
+#endif
+#if defined(FRAMELESS_BLUR_AVX2)
+    case Avx2Kernel:
+        return qCpuHasFeature(AVX2);
+#endif
+    default:
+        return false;
+    }
+}
+
+const char *ShadowGenerator::kernelName(BlurKernel kernel)
+{
+    switch(resolveKernel(kernel)) {
+    case Avx2Kernel:
+        return "avx2";
+    case Sse2Kernel:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
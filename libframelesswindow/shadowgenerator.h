@@ -0,0 +1,80 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * shadowgenerator.h
+ * 按半径、颜色、扩展程序化生成窗口阴影九宫格图片。
+ *
+ */
+
+#ifndef SHADOWGENERATOR_H
+#define SHADOWGENERATOR_H
+
+#include <QPixmap>
+#include <QImage>
+#include <QColor>
+#include <QString>
+
+/**
+ * @brief The ShadowGenerator class
+ *  只模糊一个角和一条1像素宽的边，再镜像、拉伸拼成九宫格，
+ *  生成的图片边框宽度和边距都是 radius + spread。
+ */
+class ShadowGenerator
+{
+public:
+    enum BlurKernel {
+        AutoKernel = 0,  // 运行时检测CPU，使用最快的实现(AVX2/SSE2)
+        ScalarKernel,    // 纯C++实现
+        Sse2Kernel,
+        Avx2Kernel
+    };
+
+    /**
+     * @brief generate
+     * @note 生成阴影九宫格图片
+     * @param radius 模糊半径
+     * @param color 阴影颜色
+     * @param spread 模糊前阴影向外扩展的像素
+     * @param kernel
+     * @return
+     */
+    static QImage generate(int radius, const QColor &color, int spread = 0, BlurKernel kernel = AutoKernel);
+
+    /**
+     * @brief pixmap
+     * @note 同generate，结果放入QPixmapCache，相同参数只生成一次
+     */
+    static QPixmap pixmap(int radius, const QColor &color, int spread = 0);
+
+    /**
+     * @brief cacheKey
+     * @note 阴影图片在QPixmapCache中的键
+     */
+    static QString cacheKey(int radius, const QColor &color, int spread);
+
+    /**
+     * @brief gaussianBlur
+     * @note 用三次盒式模糊近似高斯模糊，image必须是ARGB32_Premultiplied
+     * @param image
+     * @param sigma
+     * @param horizontal 是否做水平方向模糊
+     * @param vertical 是否做垂直方向模糊
+     * @param kernel
+     */
+    static void gaussianBlur(QImage &image, qreal sigma, bool horizontal = true, bool vertical = true,
+                             BlurKernel kernel = AutoKernel);
+
+    /**
+     * @brief hasKernel
+     * @note 编译器和当前CPU是否都支持该实现。不支持的实现按AutoKernel处理
+     */
+    static bool hasKernel(BlurKernel kernel);
+
+    /**
+     * @brief kernelName
+     * @note kernel实际使用的实现: "avx2"、"sse2"或"scalar"
+     */
+    static const char *kernelName(BlurKernel kernel = AutoKernel);
+};
+
+#endif // SHADOWGENERATOR_H
@@ -0,0 +1,249 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * shadowtilecache.cpp
+ * 进程内共享的阴影切片缓存。
+ *
+ */
+
+#include "shadowtilecache.h"
+#include "borderimage.h"
+#include <QPainter>
+#include <QImage>
+#include <QHash>
+#include <QWeakPointer>
+#include <QtMath>
+
+namespace {
+
+struct ShadowTileKey
+{
+    QString  source;
+    QMargins border;
+    qreal    dpr;
+
+    bool operator==(const ShadowTileKey &other) const
+    {
+        return source == other.source && border == other.border
+               && qFuzzyCompare(dpr, other.dpr);
+    }
+};
+
+inline uint qHash(const QMargins &m, uint seed = 0)
+{
+    return ::qHash(m.left(), seed) ^ ::qHash(m.top(), seed + 1)
+           ^ ::qHash(m.right(), seed + 2) ^ ::qHash(m.bottom(), seed + 3);
+}
+
+inline uint qHash(const ShadowTileKey &key, uint seed = 0)
+{
+    return ::qHash(key.source, seed) ^ qHash(key.border, seed)
+           ^ ::qHash(qRound(key.dpr * 100), seed);
+}
+
+typedef QHash<ShadowTileKey, QWeakPointer<const ShadowTiles> > ShadowTileHash;
+Q_GLOBAL_STATIC(ShadowTileHash, s_shadowTiles)
+
+//切片的平均颜色，按预乘的分量平均后再还原
+QColor averageColor(const QPixmap &tile)
+{
+    if(tile.isNull()) {
+        return QColor(Qt::transparent);
+    }
+
+    const QImage image = tile.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    qint64 a = 0, r = 0, g = 0, b = 0;
+    for(int y = 0; y < image.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        for(int x = 0; x < image.width(); ++x) {
+            a += qAlpha(line[x]);
+            r += qRed(line[x]);
+            g += qGreen(line[x]);
+            b += qBlue(line[x]);
+        }
+    }
+    const qint64 n = qint64(image.width()) * image.height();
+    const QRgb premultiplied = qRgba(int(r / n), int(g / n), int(b / n), int(a / n));
+    return QColor::fromRgba(qUnpremultiply(premultiplied));
+}
+
+} // namespace
+
+ShadowTiles::ShadowTiles(const QPixmap &source, const QMargins &border, qreal dpr)
+    : m_bCenterTransparent(true)
+    , m_border(border)
+    , m_dpr(dpr)
+{
+    if(source.isNull()) {
+        return;
+    }
+
+    //按目标设备像素比缩放一次，绘制时不再缩放角
+    QPixmap scaled = source;
+    const qreal factor = dpr / source.devicePixelRatio();
+    if(!qFuzzyCompare(factor, qreal(1))) {
+        scaled = source.scaled(qCeil(source.width() * factor), qCeil(source.height() * factor),
+                               Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    scaled.setDevicePixelRatio(dpr);
+
+    const int w = scaled.width();
+    const int h = scaled.height();
+    const int l = qRound(border.left() * dpr);
+    const int t = qRound(border.top() * dpr);
+    const int r = qRound(border.right() * dpr);
+    const int b = qRound(border.bottom() * dpr);
+    const int cw = w - l - r;
+    const int ch = h - t - b;
+
+    m_tiles[TopLeft]     = scaled.copy(0, 0, l, t);
+    m_tiles[Top]         = scaled.copy(l, 0, cw, t);
+    m_tiles[TopRight]    = scaled.copy(w - r, 0, r, t);
+    m_tiles[Left]        = scaled.copy(0, t, l, ch);
+    m_tiles[Right]       = scaled.copy(w - r, t, r, ch);
+    m_tiles[BottomLeft]  = scaled.copy(0, h - b, l, b);
+    m_tiles[Bottom]      = scaled.copy(l, h - b, cw, b);
+    m_tiles[BottomRight] = scaled.copy(w - r, h - b, r, b);
+    m_tiles[Center]      = scaled.copy(l, t, cw, ch);
+
+    for(int i = 0; i < TileCount; ++i) {
+        m_tiles[i].setDevicePixelRatio(dpr);
+    }
+
+    const Tile edges[] = { Top, Left, Right, Bottom };
+    for(const Tile edge : edges) {
+        m_edgeColors[edge] = averageColor(m_tiles[edge]);
+    }
+
+    //阴影图片的中间通常是透明的，切片时检查一次，绘制时跳过
+    if(!m_tiles[Center].isNull() && m_tiles[Center].hasAlphaChannel()) {
+        const QImage center = m_tiles[Center].toImage().convertToFormat(QImage::Format_ARGB32);
+        for(int y = 0; y < center.height() && m_bCenterTransparent; ++y) {
+            const QRgb *line = reinterpret_cast<const QRgb *>(center.constScanLine(y));
+            for(int x = 0; x < center.width(); ++x) {
+                if(qAlpha(line[x]) != 0) {
+                    m_bCenterTransparent = false;
+                    break;
+                }
+            }
+        }
+    } else {
+        m_bCenterTransparent = m_tiles[Center].isNull();
+    }
+}
+
+qint64 ShadowTiles::byteCount() const
+{
+    qint64 bytes = 0;
+    for(int i = 0; i < TileCount; ++i) {
+        const QPixmap &p = m_tiles[i];
+        bytes += qint64(p.width()) * p.height() * p.depth() / 8;
+    }
+    return bytes;
+}
+
+void ShadowTiles::draw(QPainter *painter, const QRect &rect) const
+{
+    const int l = m_border.left();
+    const int t = m_border.top();
+    const int r = m_border.right();
+    const int b = m_border.bottom();
+
+    const int x = rect.x();
+    const int y = rect.y();
+    const int w = rect.width();
+    const int h = rect.height();
+    const int cw = w - l - r;
+    const int ch = h - t - b;
+
+    //四个角，原尺寸
+    painter->drawPixmap(x, y, m_tiles[TopLeft]);
+    painter->drawPixmap(x + w - r, y, m_tiles[TopRight]);
+    painter->drawPixmap(x, y + h - b, m_tiles[BottomLeft]);
+    painter->drawPixmap(x + w - r, y + h - b, m_tiles[BottomRight]);
+
+    //四条边，沿边拉伸
+    if(cw > 0) {
+        painter->drawPixmap(QRect(x + l, y, cw, t), m_tiles[Top]);
+        painter->drawPixmap(QRect(x + l, y + h - b, cw, b), m_tiles[Bottom]);
+    }
+    if(ch > 0) {
+        painter->drawPixmap(QRect(x, y + t, l, ch), m_tiles[Left]);
+        painter->drawPixmap(QRect(x + w - r, y + t, r, ch), m_tiles[Right]);
+    }
+
+    drawCenter(painter, rect);
+}
+
+void ShadowTiles::drawCenter(QPainter *painter, const QRect &rect) const
+{
+    const int cw = rect.width() - m_border.left() - m_border.right();
+    const int ch = rect.height() - m_border.top() - m_border.bottom();
+    if(m_bCenterTransparent || cw <= 0 || ch <= 0) {
+        return;
+    }
+
+    //中间，向两个方向拉伸
+    painter->drawPixmap(QRect(rect.x() + m_border.left(), rect.y() + m_border.top(), cw, ch), m_tiles[Center]);
+}
+
+void ShadowTiles::drawFlat(QPainter *painter, const QRect &rect) const
+{
+    const int l = m_border.left();
+    const int t = m_border.top();
+    const int r = m_border.right();
+    const int b = m_border.bottom();
+
+    const int x = rect.x();
+    const int y = rect.y();
+    const int w = rect.width();
+    const int h = rect.height();
+    const int cw = w - l - r;
+    const int ch = h - t - b;
+
+    //四个角和draw一样只是拷贝，边不缩放切片，直接填充纯色
+    painter->drawPixmap(x, y, m_tiles[TopLeft]);
+    painter->drawPixmap(x + w - r, y, m_tiles[TopRight]);
+    painter->drawPixmap(x, y + h - b, m_tiles[BottomLeft]);
+    painter->drawPixmap(x + w - r, y + h - b, m_tiles[BottomRight]);
+
+    if(cw > 0) {
+        painter->fillRect(QRect(x + l, y, cw, t), m_edgeColors[Top]);
+        painter->fillRect(QRect(x + l, y + h - b, cw, b), m_edgeColors[Bottom]);
+    }
+    if(ch > 0) {
+        painter->fillRect(QRect(x, y + t, l, ch), m_edgeColors[Left]);
+        painter->fillRect(QRect(x + w - r, y + t, r, ch), m_edgeColors[Right]);
+    }
+}
+
+QSharedPointer<const ShadowTiles> ShadowTileCache::acquire(const BorderImage &image, qreal dpr)
+{
+    ShadowTileKey key;
+    key.source = image.pixmap_url().isEmpty()
+                 ? QStringLiteral("pixmap:%1").arg(image.pixmap().cacheKey())
+                 : image.pixmap_url();
+    key.border = image.border();
+    key.dpr = dpr;
+
+    QSharedPointer<const ShadowTiles> tiles = s_shadowTiles()->value(key).toStrongRef();
+    if(tiles) {
+        return tiles;
+    }
+
+    //最后一个窗口释放时从缓存中移除
+    tiles = QSharedPointer<const ShadowTiles>(new ShadowTiles(image.pixmap(), image.border(), dpr),
+    [key](const ShadowTiles * p) {
+        if(!s_shadowTiles.isDestroyed()) {
+            s_shadowTiles()->remove(key);
+        }
+        delete p;
+    });
+    s_shadowTiles()->insert(key, tiles);
+    return tiles;
+}
+
+int ShadowTileCache::count()
+{
+    return s_shadowTiles()->size();
+}
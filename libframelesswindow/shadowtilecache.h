@@ -0,0 +1,110 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * shadowtilecache.h
+ * 进程内共享的阴影切片缓存，所有窗口共用同一份四角、四边切片。
+ *
+ */
+
+#ifndef SHADOWTILECACHE_H
+#define SHADOWTILECACHE_H
+
+#include <QPixmap>
+#include <QColor>
+#include <QMargins>
+#include <QSharedPointer>
+
+class QPainter;
+class QRect;
+class BorderImage;
+
+/**
+ * @brief The ShadowTiles class
+ *  预先切好的阴影切片：四个角按原尺寸绘制，四条边沿边方向拉伸，中间向两个方向拉伸
+ */
+class ShadowTiles
+{
+public:
+    enum Tile {
+        TopLeft = 0,
+        Top,
+        TopRight,
+        Left,
+        Right,
+        BottomLeft,
+        Bottom,
+        BottomRight,
+        Center,
+        TileCount
+    };
+
+    ShadowTiles(const QPixmap &source, const QMargins &border, qreal dpr);
+
+    const QPixmap &tile(Tile t) const { return m_tiles[t]; }
+    const QMargins &border() const { return m_border; }
+    qreal devicePixelRatio() const { return m_dpr; }
+
+    /**
+     * @brief byteCount
+     * @note 所有切片占用的字节数
+     */
+    qint64 byteCount() const;
+
+    /**
+     * @brief draw
+     * @note 和qDrawBorderPixmap一样画九宫格：边框区域画阴影环，中间拉伸到rect内部
+     * @param painter
+     * @param rect
+     */
+    void draw(QPainter *painter, const QRect &rect) const;
+
+    /**
+     * @brief drawCenter
+     * @note 只画中间的切片，完全透明时什么也不画
+     * @param painter
+     * @param rect 与draw相同的整个阴影矩形
+     */
+    void drawCenter(QPainter *painter, const QRect &rect) const;
+
+    /**
+     * @brief drawFlat
+     * @note 低质量的阴影环：四个角原尺寸绘制，四条边用切片的平均颜色填充，不拉伸任何切片。
+     *  用于拖动缩放，不画中间的切片
+     * @param painter
+     * @param rect 与draw相同的整个阴影矩形
+     */
+    void drawFlat(QPainter *painter, const QRect &rect) const;
+
+private:
+    QPixmap  m_tiles[TileCount];
+    QColor   m_edgeColors[TileCount]; //四条边切片的平均颜色，drawFlat使用
+    bool     m_bCenterTransparent;  //中间切片完全透明，不需要绘制
+    QMargins m_border;
+    qreal    m_dpr;
+};
+
+/**
+ * @brief The ShadowTileCache class
+ *  按(边框图片, border, 设备像素比)共享阴影切片，引用计数归零后自动释放。
+ *  只能在GUI线程中使用。
+ */
+class ShadowTileCache
+{
+public:
+    /**
+     * @brief acquire
+     * @note 取得与image、dpr对应的切片，不存在时切一份新的
+     * @param image
+     * @param dpr
+     * @return
+     */
+    static QSharedPointer<const ShadowTiles> acquire(const BorderImage &image, qreal dpr);
+
+    /**
+     * @brief count
+     * @note 当前缓存中仍被引用的切片组数量
+     */
+    static int count();
+};
+
+#endif // SHADOWTILECACHE_H
@@ -0,0 +1,146 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * spriteatlas.cpp
+ * 进程内共享的按钮状态帧。
+ *
+ */
+
+#include "spriteatlas.h"
+#include <QHash>
+#include <QWeakPointer>
+#include <QFileInfo>
+#include <QtMath>
+
+namespace {
+
+struct SpriteKey
+{
+    QString source;
+    int     stateCount;
+    int     dpr;   // 设备像素比 * 100
+
+    bool operator==(const SpriteKey &other) const
+    {
+        return source == other.source && stateCount == other.stateCount && dpr == other.dpr;
+    }
+};
+
+inline uint qHash(const SpriteKey &key, uint seed = 0)
+{
+    return ::qHash(key.source, seed) ^ ::qHash(key.stateCount, seed + 1) ^ ::qHash(key.dpr, seed + 2);
+}
+
+typedef QHash<SpriteKey, QWeakPointer<const SpriteFrames> > SpriteHash;
+Q_GLOBAL_STATIC(SpriteHash, s_sprites)
+
+int s_nDecodeCount = 0;
+
+/*
+ * 按设备像素比查找高分辨率图片，":/a/b.png"在2倍屏上查找":/a/b@2x.png"，
+ * 找不到时依次降低倍数，都没有则加载原图
+ */
+QPixmap loadForDpr(const QString &fileName, qreal dpr)
+{
+    ++s_nDecodeCount;
+
+    const QFileInfo info(fileName);
+    const QString base = info.path() + '/' + info.completeBaseName();
+    const QString suffix = info.suffix().isEmpty() ? QString() : '.' + info.suffix();
+
+    for(int n = qCeil(dpr); n >= 2; --n) {
+        const QString candidate = QString("%1@%2x%3").arg(base).arg(n).arg(suffix);
+        if(QFileInfo::exists(candidate)) {
+            QPixmap pixmap(candidate);
+            if(!pixmap.isNull()) {
+                pixmap.setDevicePixelRatio(n);
+                return pixmap;
+            }
+        }
+    }
+
+    QPixmap pixmap;
+    pixmap.load(fileName);
+    return pixmap;
+}
+
+QSharedPointer<const SpriteFrames> acquireFrames(const SpriteKey &key, const QPixmap &strip, qreal dpr)
+{
+    //最后一个按钮释放时从缓存中移除
+    QSharedPointer<const SpriteFrames> frames(new SpriteFrames(strip, key.stateCount, dpr),
+    [key](const SpriteFrames * p) {
+        if(!s_sprites.isDestroyed()) {
+            s_sprites()->remove(key);
+        }
+        delete p;
+    });
+    s_sprites()->insert(key, frames);
+    return frames;
+}
+
+} // namespace
+
+SpriteFrames::SpriteFrames(const QPixmap &strip, int stateCount, qreal dpr)
+    : m_frameSize(0, 0)     //图片为空时按钮大小为0x0，而不是无效的(-1,-1)
+    , m_dpr(dpr)
+{
+    if(strip.isNull() || stateCount <= 0) {
+        return;
+    }
+
+    const qreal sourceDpr = strip.devicePixelRatio();
+    const int frameWidth = strip.width() / stateCount;
+    const int frameHeight = strip.height();
+    m_frameSize = QSize(qRound(frameWidth / sourceDpr), qRound(frameHeight / sourceDpr));
+
+    //目标物理大小，原图倍数不够时平滑放大一次
+    const QSize target(qRound(m_frameSize.width() * dpr), qRound(m_frameSize.height() * dpr));
+
+    m_frames.reserve(stateCount);
+    for(int i = 0; i < stateCount; ++i) {
+        QPixmap frame = strip.copy(frameWidth * i, 0, frameWidth, frameHeight);
+        if(frame.size() != target) {
+            frame = frame.scaled(target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        frame.setDevicePixelRatio(dpr);
+        m_frames.append(frame);
+    }
+}
+
+QSharedPointer<const SpriteFrames> SpriteAtlas::acquire(const QString &fileName, int stateCount, qreal dpr)
+{
+    SpriteKey key;
+    key.source = fileName;
+    key.stateCount = stateCount;
+    key.dpr = qRound(dpr * 100);
+
+    QSharedPointer<const SpriteFrames> frames = s_sprites()->value(key).toStrongRef();
+    if(frames) {
+        return frames;
+    }
+    return acquireFrames(key, loadForDpr(fileName, dpr), dpr);
+}
+
+QSharedPointer<const SpriteFrames> SpriteAtlas::acquire(const QPixmap &pixmap, int stateCount, qreal dpr)
+{
+    SpriteKey key;
+    key.source = QStringLiteral("pixmap:%1").arg(pixmap.cacheKey());
+    key.stateCount = stateCount;
+    key.dpr = qRound(dpr * 100);
+
+    QSharedPointer<const SpriteFrames> frames = s_sprites()->value(key).toStrongRef();
+    if(frames) {
+        return frames;
+    }
+    return acquireFrames(key, pixmap, dpr);
+}
+
+int SpriteAtlas::count()
+{
+    return s_sprites()->size();
+}
+
+int SpriteAtlas::decodeCount()
+{
+    return s_nDecodeCount;
+}
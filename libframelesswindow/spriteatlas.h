@@ -0,0 +1,79 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * spriteatlas.h
+ * 进程内共享的按钮状态帧：多状态横条图片只切一次，所有按钮共用。
+ *
+ */
+
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QPixmap>
+#include <QVector>
+#include <QSharedPointer>
+
+/**
+ * @brief The SpriteFrames class
+ *  横向排列的多状态图片(normal/hover/pressed/disabled/checked)切成的各帧，
+ *  已经按设备像素比缩放，绘制时不再拷贝或缩放
+ */
+class SpriteFrames
+{
+public:
+    SpriteFrames(const QPixmap &strip, int stateCount, qreal dpr);
+
+    int count() const { return m_frames.size(); }
+    const QPixmap &frame(int index) const { return m_frames.at(index); }
+
+    /**
+     * @brief frameSize
+     * @note 一帧的逻辑大小
+     */
+    QSize frameSize() const { return m_frameSize; }
+    qreal devicePixelRatio() const { return m_dpr; }
+
+private:
+    QVector<QPixmap> m_frames;
+    QSize m_frameSize;
+    qreal m_dpr;
+};
+
+/**
+ * @brief The SpriteAtlas class
+ *  按(图片来源, 状态数, 设备像素比)共享SpriteFrames，引用计数归零后自动释放。
+ *  从文件加载时优先使用同名的@Nx高分辨率图片。只能在GUI线程中使用。
+ */
+class SpriteAtlas
+{
+public:
+    /**
+     * @brief acquire
+     * @note 取得图片文件对应的帧，不存在时加载并切片
+     * @param fileName 图片路径，高分屏上优先查找name@2x.png等
+     * @param stateCount 图片包含的状态数
+     * @param dpr 设备像素比
+     * @return
+     */
+    static QSharedPointer<const SpriteFrames> acquire(const QString &fileName, int stateCount, qreal dpr);
+
+    /**
+     * @brief acquire
+     * @note 取得内存中图片对应的帧，按QPixmap::cacheKey区分
+     */
+    static QSharedPointer<const SpriteFrames> acquire(const QPixmap &pixmap, int stateCount, qreal dpr);
+
+    /**
+     * @brief count
+     * @note 当前仍被引用的帧组数量
+     */
+    static int count();
+
+    /**
+     * @brief decodeCount
+     * @note 从文件解码图片的累计次数，命中已有的帧不计入
+     */
+    static int decodeCount();
+};
+
+#endif // SPRITEATLAS_H
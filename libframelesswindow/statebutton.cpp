@@ -4,39 +4,107 @@
 #include <QStyleOptionButton>
 #include <QStyle>
 
+namespace {
+
+bool s_bNativeRendering = false;
+
+} // namespace
+
 StateButton::StateButton(QWidget *parent)
     :QPushButton(parent)
+    ,m_icon(-1)
+    ,m_pixmapType(NONE)
     ,m_status(NORMAL)
     ,m_mousePressed(false)
-    ,m_pixmapType(NONE)
+    ,m_bNative(s_bNativeRendering)
+    ,m_hoverColor(Qt::transparent)
+    ,m_pressedColor(Qt::transparent)
 {
-    setStyleSheet("QPushButton{background:transparent;border:none;}");
+    if(!m_bNative) {
+        setStyleSheet("QPushButton{background:transparent;border:none;}");
+    }
 }
 
 StateButton::~StateButton()
 {
 }
 
+void StateButton::setNativeRendering(bool native)
+{
+    s_bNativeRendering = native;
+}
+
+bool StateButton::nativeRendering()
+{
+    return s_bNativeRendering;
+}
+
+void StateButton::setHoverColor(const QColor &color)
+{
+    m_hoverColor = color;
+    update();
+}
+
+void StateButton::setPressedColor(const QColor &color)
+{
+    m_pressedColor = color;
+    update();
+}
+
 void StateButton::loadPixmap(const QString& pic_name, int state_count)
 {
     m_pixmapType = FOREGROUND;
-    m_pixmap.load(pic_name);
+    m_icon        = -1;
+    m_pixmapPath  = pic_name;
+    m_pixmap      = QPixmap();
     m_stateCount = state_count;
-    m_width       = m_pixmap.width()/state_count;
-    m_height      = m_pixmap.height();
-    setFixedSize(m_width, m_height);
+    acquire_frames();
 }
 
 void StateButton::setPixmap(const QPixmap& pixmap, int state_count)
 {
     m_pixmapType = FOREGROUND;
+    m_icon        = -1;
+    m_pixmapPath.clear();
     m_pixmap      = pixmap;
     m_stateCount = state_count;
-    m_width       = m_pixmap.width()/state_count;
-    m_height      = m_pixmap.height();
+    acquire_frames();
+}
+
+void StateButton::loadIcon(IconAtlas::Icon icon)
+{
+    m_pixmapType = FOREGROUND;
+    m_icon        = icon;
+    m_pixmapPath  = IconAtlas::fileName(icon);
+    m_pixmap      = QPixmap();
+    m_stateCount = IconAtlas::stateCount(icon);
+    acquire_frames();
+}
+
+void StateButton::acquire_frames()
+{
+    const qreal dpr = devicePixelRatioF();
+    if(m_icon >= 0) {
+        m_frames = IconAtlas::frames(IconAtlas::Icon(m_icon), dpr);
+    } else if(m_pixmapPath.isEmpty()) {
+        m_frames = SpriteAtlas::acquire(m_pixmap, m_stateCount, dpr);
+    } else {
+        m_frames = SpriteAtlas::acquire(m_pixmapPath, m_stateCount, dpr);
+    }
+
+    m_width       = m_frames->frameSize().width();
+    m_height      = m_frames->frameSize().height();
     setFixedSize(m_width, m_height);
 }
 
+void StateButton::update_frames_dpr()
+{
+    if(m_frames && !qFuzzyCompare(m_frames->devicePixelRatio(), devicePixelRatioF())) {
+        acquire_frames();
+        update();
+    }
+}
+
 void StateButton::loadBackground(const QString& pic_name, int state_count/*=4*/)
 {
     loadPixmap(pic_name, state_count);
@@ -49,6 +117,20 @@ void StateButton::setBackground(const QPixmap& pixmap, int state_count/*=4*/)
     m_pixmapType = BACKGROUND;
 }
 
+bool StateButton::event(QEvent *e)
+{
+    //创建时可能还没有所在的屏幕，显示或移到不同设备像素比的屏幕后重新取帧
+    switch(e->type()) {
+    case QEvent::Show:
+    case QEvent::ScreenChangeInternal:
+        update_frames_dpr();
+        break;
+    default:
+        break;
+    }
+    return QPushButton::event(e);
+}
+
 void StateButton::enterEvent(QEvent *e)
 {
     m_status = HOVER;
@@ -98,29 +180,67 @@ void StateButton::leaveEvent(QEvent *e)
 
 void StateButton::paintEvent(QPaintEvent *e)
 {
+    if(m_bNative) {
+        paint_native();
+        return;
+    }
+
     if(m_pixmapType == BACKGROUND) {
-        paint_pixmap();
+        QPainter painter(this);
+        paint_pixmap(&painter);
     }
 
     // QPushButton::paintEvent(e);
-    QStylePainter p(this);
-    QStyleOptionButton option;
-    initStyleOption(&option);
-    if(option.state & QStyle::State_HasFocus) {
-        option.state ^= QStyle::State_HasFocus;    //去除焦点框
-        option.state |= QStyle::State_MouseOver;
+    {
+        QStylePainter p(this);
+        QStyleOptionButton option;
+        initStyleOption(&option);
+        if(option.state & QStyle::State_HasFocus) {
+            option.state ^= QStyle::State_HasFocus;    //去除焦点框
+            option.state |= QStyle::State_MouseOver;
+        }
+        p.drawControl(QStyle::CE_PushButton, option);
     }
-    p.drawControl(QStyle::CE_PushButton, option);
 
     if(m_pixmapType == FOREGROUND) {
-        paint_pixmap();
+        QPainter painter(this);
+        paint_pixmap(&painter);
     }
 }
 
-void StateButton::paint_pixmap()
+void StateButton::paint_native()
 {
     QPainter painter(this);
 
+    //背景透明，鼠标划过、按下时填充属性设置的颜色
+    if(isEnabled()) {
+        const QColor &color = (m_status == PRESSED) ? m_pressedColor
+                              : (m_status == HOVER) ? m_hoverColor : QColor(Qt::transparent);
+        if(color.alpha() > 0) {
+            painter.fillRect(rect(), color);
+        }
+    }
+
+    if(m_pixmapType == BACKGROUND) {
+        paint_pixmap(&painter);
+    }
+
+    if(!text().isEmpty()) {
+        painter.setPen(palette().color(isEnabled() ? QPalette::Active : QPalette::Disabled, QPalette::ButtonText));
+        painter.drawText(rect(), Qt::AlignCenter, text());
+    }
+
+    if(m_pixmapType == FOREGROUND) {
+        paint_pixmap(&painter);
+    }
+}
+
+void StateButton::paint_pixmap(QPainter *painter)
+{
+    if(!m_frames || m_frames->count() == 0) {
+        return;
+    }
+
     //根据状态显示图片
     ButtonStatus status = m_status;
     if(!isEnabled()) {
@@ -133,11 +253,11 @@ void StateButton::paint_pixmap()
         }
     }
 
-    if(status >= m_stateCount) {
+    if(status >= m_frames->count()) {
         status = NORMAL;
     }
 
-    painter.drawPixmap(rect(), m_pixmap.copy(m_width * status, 0, m_width, m_height));
+    painter->drawPixmap(rect(), m_frames->frame(status));
 }
 //////////////////////////////////////////////////////////////////////////
 
@@ -182,12 +302,79 @@ void IconTextButton::paintEvent(QPaintEvent *e)
 
 TextButton::TextButton(QWidget *parent)
     :QPushButton(parent)
+    ,m_bNative(s_bNativeRendering)
+    ,m_hoverColor(Qt::transparent)
+    ,m_pressedColor(Qt::transparent)
 {
     this->setFlat(true);
-    this->setStyleSheet("QPushButton{background: transparent;}");
+    if(m_bNative) {
+        //没有样式表时需要自己在鼠标进出时重绘
+        this->setAttribute(Qt::WA_Hover, true);
+    } else {
+        this->setStyleSheet("QPushButton{background: transparent;}");
+    }
 }
 
 TextButton::~TextButton()
 {
 
 }
+
+void TextButton::setTextColor(const QColor &color)
+{
+    m_textColor = color;
+    update();
+}
+
+void TextButton::setHoverColor(const QColor &color)
+{
+    m_hoverColor = color;
+    update();
+}
+
+void TextButton::setPressedColor(const QColor &color)
+{
+    m_pressedColor = color;
+    update();
+}
+
+void TextButton::paintEvent(QPaintEvent *e)
+{
+    if(!m_bNative) {
+        QPushButton::paintEvent(e);
+        return;
+    }
+
+    QPainter painter(this);
+    if(isEnabled()) {
+        const QColor &color = isDown() ? m_pressedColor
+                              : underMouse() ? m_hoverColor : QColor(Qt::transparent);
+        if(color.alpha() > 0) {
+            painter.fillRect(rect(), color);
+        }
+    }
+
+    //图标在左，文字在右，整体居中
+    const QPixmap pixmap = icon().isNull() ? QPixmap()
+                           : icon().pixmap(iconSize(), isEnabled() ? QIcon::Normal : QIcon::Disabled);
+    const QSize pixmapSize = pixmap.isNull() ? QSize(0, 0) : pixmap.size() / pixmap.devicePixelRatio();
+    const int spacing = (pixmap.isNull() || text().isEmpty()) ? 0 : 4;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    const int textWidth = fontMetrics().horizontalAdvance(text());
+#else
+    const int textWidth = fontMetrics().width(text());
+#endif
+    int x = (width() - pixmapSize.width() - spacing - textWidth) / 2;
+
+    if(!pixmap.isNull()) {
+        painter.drawPixmap(x, (height() - pixmapSize.height()) / 2, pixmap);
+        x += pixmapSize.width() + spacing;
+    }
+
+    QColor textColor = m_textColor.isValid() ? m_textColor : palette().color(QPalette::ButtonText);
+    if(!isEnabled()) {
+        textColor = palette().color(QPalette::Disabled, QPalette::ButtonText);
+    }
+    painter.setPen(textColor);
+    painter.drawText(QRect(x, 0, textWidth, height()), Qt::AlignVCenter | Qt::AlignLeft, text());
+}
@@ -5,24 +5,51 @@
 #include <QPushButton>
 #include <QPainter>
 #include <QMouseEvent>
+#include <QSharedPointer>
+#include "spriteatlas.h"
+#include "iconatlas.h"
 
 //a pixmap have 5 picture which state is normal\hover\pressed\disabled\checked
 //this button does not draw focus rect
 class StateButton : public QPushButton
 {
     Q_OBJECT
+    //原生绘制时的背景颜色，应用程序的QSS可以用qproperty-hoverColor等设置
+    Q_PROPERTY(QColor hoverColor READ hoverColor WRITE setHoverColor)
+    Q_PROPERTY(QColor pressedColor READ pressedColor WRITE setPressedColor)
+    //是否原生绘制，hoverColor等属性只在原生绘制时生效
+    Q_PROPERTY(bool nativeRendering READ isNativeRendering)
 public:
     explicit StateButton(QWidget *parent = 0);
     ~StateButton();
 
+    /**
+     * @brief setNativeRendering
+     * @note 原生绘制：之后创建的StateButton、TextButton不再调用setStyleSheet，
+     *  直接绘制透明背景和状态图片，按钮颜色通过hoverColor等属性设置。需在创建按钮前调用
+     * @param native
+     */
+    static void setNativeRendering(bool native);
+    static bool nativeRendering();
+    //本按钮创建时是否为原生绘制
+    bool isNativeRendering() const { return m_bNative; }
+
+    QColor hoverColor() const { return m_hoverColor; }
+    void setHoverColor(const QColor &color);
+    QColor pressedColor() const { return m_pressedColor; }
+    void setPressedColor(const QColor &color);
+
 public:
     void loadPixmap(const QString& pic_name, int state_count=4);
     void setPixmap(const QPixmap& pixmap, int state_count=4);
+    //使用全局图集中的图标，不解码PNG
+    void loadIcon(IconAtlas::Icon icon);
 
     void loadBackground(const QString& pic_name, int state_count=4);
     void setBackground(const QPixmap& pixmap, int state_count=4);
 
 protected:
+    bool event(QEvent *e);
     void enterEvent(QEvent *);
     void leaveEvent(QEvent *);
     void mousePressEvent(QMouseEvent *event);
@@ -30,7 +57,13 @@ protected:
     void paintEvent(QPaintEvent *);
 
 private:
-    void paint_pixmap();
+    void paint_pixmap(QPainter *painter);
+    //原生绘制，不经过样式
+    void paint_native();
+    //从进程内共享的SpriteAtlas取得切好的各状态帧
+    void acquire_frames();
+    //设备像素比与当前帧不同时重新取帧，只在显示、换屏时调用，不在绘制中改变大小
+    void update_frames_dpr();
 
 private:
     //枚举按钮的几种状态
@@ -38,13 +71,19 @@ private:
     //pximap_位图类型, 仅能选择其一. 如果两者都需要，请选择BACKGROUND + QPushButton::setIcon
     enum PixmapType   {NONE, FOREGROUND, BACKGROUND};
 
-    QPixmap         m_pixmap;        //图片
+    QPixmap         m_pixmap;        //图片(setPixmap设置时)
+    QString         m_pixmapPath;    //图片路径(loadPixmap设置时)
+    int             m_icon;          //图集中的图标(loadIcon设置时)，-1表示没有
+    QSharedPointer<const SpriteFrames> m_frames; //切好的各状态帧
     PixmapType      m_pixmapType;
     int             m_stateCount;    //图片有几种状态(几张子图)
     ButtonStatus    m_status;        //当前状态
     int             m_width;         //按钮宽度
     int             m_height;        //按钮高度
     bool            m_mousePressed;  //鼠标左键是否按下
+    bool            m_bNative;       //是否原生绘制(创建时决定)
+    QColor          m_hoverColor;    //原生绘制时鼠标划过的背景色
+    QColor          m_pressedColor;  //原生绘制时鼠标按下的背景色
 };
 
 //按钮的图标在上面，文字在下面
@@ -61,9 +100,32 @@ protected:
 class TextButton: public QPushButton
 {
     Q_OBJECT
+    //原生绘制(StateButton::setNativeRendering)时的颜色，应用程序的QSS可以用qproperty-textColor等设置
+    Q_PROPERTY(QColor textColor READ textColor WRITE setTextColor)
+    Q_PROPERTY(QColor hoverColor READ hoverColor WRITE setHoverColor)
+    Q_PROPERTY(QColor pressedColor READ pressedColor WRITE setPressedColor)
+    Q_PROPERTY(bool nativeRendering READ isNativeRendering)
 public:
     TextButton(QWidget *parent = 0);
     ~TextButton();
+
+    bool isNativeRendering() const { return m_bNative; }
+
+    QColor textColor() const { return m_textColor; }
+    void setTextColor(const QColor &color);
+    QColor hoverColor() const { return m_hoverColor; }
+    void setHoverColor(const QColor &color);
+    QColor pressedColor() const { return m_pressedColor; }
+    void setPressedColor(const QColor &color);
+
+protected:
+    void paintEvent(QPaintEvent *e);
+
+private:
+    bool   m_bNative;       //是否原生绘制(创建时决定)
+    QColor m_textColor;     //为空时使用调色板的ButtonText
+    QColor m_hoverColor;
+    QColor m_pressedColor;
 };
 
 #endif //
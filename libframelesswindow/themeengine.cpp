@@ -0,0 +1,835 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * themeengine.cpp
+ * 编译后的主题：每个QSS文件只解析一次，所有无边框窗口共享，能映射的规则直接设置为调色板和属性。
+ *
+ */
+
+#include "themeengine.h"
+#include <QApplication>
+#include <QAbstractButton>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPointer>
+#include <QProxyStyle>
+#include <QRegularExpression>
+#include <QStyleOption>
+#include <QWidget>
+#include <QtDebug>
+#include <algorithm>
+
+namespace {
+
+//控件上记录主题状态的动态属性
+const char kThemeIdProperty[] = "frameless_themeId";
+const char kThemeFlagsProperty[] = "frameless_themeFlags";
+const char kBackgroundProperty[] = "frameless_themeBackground";
+const char kBorderColorProperty[] = "frameless_themeBorderColor";
+const char kBorderWidthProperty[] = "frameless_themeBorderWidth";
+const char *const kClientProperties[] = {
+    "frameless_themeClientPainting",
+    "frameless_themeClientBackground",
+    "frameless_themeClientBorderColor",
+    "frameless_themeClientBorderWidth"
+};
+const char kBindingName[] = "frameless_themeBinding";
+
+//控件被主题改过的内容，换主题时据此恢复
+enum ThemeFlag {
+    kPaletteFlag = 0x01,
+    kFontFlag = 0x02,
+    kBackgroundFlag = 0x04,
+    kStyledAttributeFlag = 0x08,    //WA_StyledBackground是主题设置的
+    kHoverColorFlag = 0x10,
+    kPressedColorFlag = 0x20,
+    kTextColorFlag = 0x40,
+    kClientFlag = 0x80              //顶层窗口的客户区背景和边框
+};
+
+struct ThemeCache
+{
+    QMutex mutex;
+    QHash<QString, QSharedPointer<const Theme> > themes;
+    ThemeStatistics statistics;
+};
+
+Q_GLOBAL_STATIC(ThemeCache, s_themeCache)
+
+QBasicAtomicInt s_nextThemeId = Q_BASIC_ATOMIC_INITIALIZER(1);
+
+/**
+ * @brief The ThemeStyle class
+ *  按控件上的主题属性绘制PE_Widget的背景和边框，其余交给应用程序的样式
+ */
+class ThemeStyle : public QProxyStyle
+{
+public:
+    virtual void drawPrimitive(PrimitiveElement element, const QStyleOption *option,
+                               QPainter *painter, const QWidget *widget = nullptr) const
+    {
+        if(element == PE_Widget && widget) {
+            const QVariant background = widget->property(kBackgroundProperty);
+            const QVariant borderColor = widget->property(kBorderColorProperty);
+            if(background.isValid() || borderColor.isValid()) {
+                if(background.isValid()) {
+                    painter->fillRect(option->rect, background.value<QColor>());
+                }
+                const int borderWidth = widget->property(kBorderWidthProperty).toInt();
+                if(borderColor.isValid() && borderWidth > 0) {
+                    //和样式表一样，边框画在控件矩形内部
+                    const qreal half = borderWidth / 2.0;
+                    QPen pen(borderColor.value<QColor>(), borderWidth);
+                    pen.setJoinStyle(Qt::MiterJoin);
+                    painter->save();
+                    painter->setPen(pen);
+                    painter->setBrush(Qt::NoBrush);
+                    painter->drawRect(QRectF(option->rect).adjusted(half, half, -half, -half));
+                    painter->restore();
+                }
+                return;
+            }
+        }
+        QProxyStyle::drawPrimitive(element, option, painter, widget);
+    }
+};
+
+QPointer<QStyle> s_pThemeStyle;
+
+/**
+ * @brief The ThemeBinding class
+ *  窗口当前的主题，作为窗口的子对象随窗口删除。窗口显示时给新建的子控件补上主题
+ */
+class ThemeBinding : public QObject
+{
+public:
+    explicit ThemeBinding(QWidget *window)
+        : QObject(window)
+        , m_pWindow(window)
+    {
+        setObjectName(kBindingName);
+        window->installEventFilter(this);
+    }
+
+    void setTheme(const QSharedPointer<const Theme> &theme)
+    {
+        //同一个主题再次应用时refresh会跳过已处理的控件，要保留它们需要的样式表规则
+        if(m_theme && theme && m_theme->id() == theme->id()) {
+            return;
+        }
+        m_theme = theme;
+        m_residualRules.fill(false, theme ? theme->rules().size() : 0);
+    }
+
+    void refresh();
+    void reset();
+
+protected:
+    virtual bool eventFilter(QObject *obj, QEvent *event)
+    {
+        if(obj == m_pWindow && event->type() == QEvent::Show) {
+            refresh();
+        }
+        return QObject::eventFilter(obj, event);
+    }
+
+private:
+    void updateStyleSheet();
+
+private:
+    QWidget *m_pWindow;
+    QSharedPointer<const Theme> m_theme;
+    QVector<bool> m_residualRules;  //需要交给样式表引擎的规则
+    QString m_residualStyleSheet;   //当前设置到窗口上的样式表
+};
+
+ThemeBinding *bindingOf(QWidget *window)
+{
+    return static_cast<ThemeBinding *>(window->findChild<QObject *>(kBindingName, Qt::FindDirectChildrenOnly));
+}
+
+//颜色名称或#RRGGBB，rgb()等形式无效，交给样式表引擎
+QColor parseColor(const QString &value)
+{
+    return QColor(value.trimmed());
+}
+
+//"12px"、"1"之类的像素值，失败返回-1
+int parsePixels(QString value)
+{
+    if(value.endsWith(QLatin1String("px"))) {
+        value.chop(2);
+    }
+    bool ok = false;
+    const int pixels = value.trimmed().toInt(&ok);
+    return ok ? pixels : -1;
+}
+
+QString unquote(QString value)
+{
+    value = value.trimmed();
+    if(value.size() >= 2 && (value.startsWith('"') || value.startsWith('\''))
+            && value.endsWith(value.at(0))) {
+        value = value.mid(1, value.size() - 2);
+    }
+    return value;
+}
+
+QString stripComments(const QString &text)
+{
+    QString result;
+    result.reserve(text.size());
+    int from = 0;
+    while(from < text.size()) {
+        const int start = text.indexOf(QLatin1String("/*"), from);
+        if(start < 0) {
+            result += text.midRef(from);
+            break;
+        }
+        result += text.midRef(from, start - from);
+        const int end = text.indexOf(QLatin1String("*/"), start + 2);
+        if(end < 0) {
+            break;
+        }
+        from = end + 2;
+    }
+    return result;
+}
+
+//Type#name[property=value]:state，其余形式(后代、子控件、多个状态等)返回false
+bool parseSelector(const QString &selector, ThemeRule &rule)
+{
+    static const QRegularExpression re(QStringLiteral(
+        "^(\\*|[A-Za-z_][A-Za-z0-9_-]*)?"
+        "(?:#([A-Za-z0-9_-]+))?"
+        "(?:\\[\\s*([A-Za-z0-9_-]+)\\s*=\\s*[\"']?([^\"'\\]]*)[\"']?\\s*\\])?"
+        "(?::([A-Za-z-]+))?$"));
+    const QRegularExpressionMatch match = re.match(selector);
+    if(selector.isEmpty() || !match.hasMatch()) {
+        return false;
+    }
+    rule.type = match.captured(1);
+    if(rule.type == QLatin1String("*")) {
+        rule.type.clear();
+    }
+    //样式表中命名空间写成ns--Class
+    rule.type.replace(QLatin1String("--"), QLatin1String("::"));
+    rule.objectName = match.captured(2);
+    rule.attrName = match.captured(3).toLatin1();
+    rule.attrValue = match.captured(4);
+    rule.pseudo = match.captured(5);
+    return true;
+}
+
+bool hasBox(const ThemeRule &rule)
+{
+    return rule.background.isValid() || rule.borderColor.isValid()
+            || rule.borderWidth >= 0 || rule.borderStyle != ThemeRule::kBorderUnset;
+}
+
+//StateButton、TextButton自己绘制，没有边框
+bool isFramelessButton(const QWidget *widget)
+{
+    return widget->inherits("StateButton") || widget->inherits("TextButton");
+}
+
+//该规则在这个控件上是否只能交给样式表引擎
+bool needsStyleSheet(const ThemeRule &rule, const QWidget *widget)
+{
+    if(!rule.unmapped.isEmpty()) {
+        return true;
+    }
+    //属性值在运行时可能改变，由样式表引擎跟踪
+    if(!rule.attrName.isEmpty()) {
+        return true;
+    }
+
+    //顶层窗口是透明的(WA_TranslucentBackground)，WidgetShadow自己绘制客户区的背景和边框，
+    //其他顶层窗口的背景和边框照旧交给样式表引擎
+    if(widget->isWindow()) {
+        if(!rule.pseudo.isEmpty()) {
+            return true;
+        }
+        return hasBox(rule) && !widget->property(ThemeEngine::clientProperty(ThemeEngine::ClientPainting)).toBool();
+    }
+
+    const bool button = qobject_cast<const QAbstractButton *>(widget) != Q_NULLPTR;
+    if(rule.pseudo.isEmpty()) {
+        if(!button || !hasBox(rule)) {
+            return false;
+        }
+        //按钮的背景和边框由样式绘制，只有"border: none"可以跳过
+        return rule.background.isValid() || rule.borderColor.isValid()
+                || rule.borderStyle == ThemeRule::kBorderSolid
+                || rule.borderWidth > 0 || !isFramelessButton(widget);
+    }
+
+    //只有原生绘制的按钮悬停、按下的背景色可以设置为属性，否则属性不会被使用
+    if(!widget->property("nativeRendering").toBool()) {
+        return true;
+    }
+    const char *property = Q_NULLPTR;
+    if(rule.pseudo == QLatin1String("hover")) {
+        property = "hoverColor";
+    } else if(rule.pseudo == QLatin1String("pressed")) {
+        property = "pressedColor";
+    }
+    if(!property || rule.color.isValid() || rule.hasFont() || rule.borderColor.isValid()
+            || rule.borderWidth >= 0 || rule.borderStyle != ThemeRule::kBorderUnset) {
+        return true;
+    }
+    return widget->metaObject()->indexOfProperty(property) < 0;
+}
+
+void resetWidget(QWidget *widget)
+{
+    const int flags = widget->property(kThemeFlagsProperty).toInt();
+    if(flags & kPaletteFlag) {
+        //没有resolve的调色板表示恢复继承
+        widget->setPalette(QPalette());
+    }
+    if(flags & kFontFlag) {
+        widget->setFont(QFont());
+    }
+    if(flags & kBackgroundFlag) {
+        widget->setProperty(kBackgroundProperty, QVariant());
+        widget->setProperty(kBorderColorProperty, QVariant());
+        widget->setProperty(kBorderWidthProperty, QVariant());
+        if(widget->style() == s_pThemeStyle) {
+            widget->setStyle(Q_NULLPTR);
+        }
+    }
+    if(flags & kStyledAttributeFlag) {
+        widget->setAttribute(Qt::WA_StyledBackground, false);
+    }
+    if(flags & kHoverColorFlag) {
+        widget->setProperty("hoverColor", QColor(Qt::transparent));
+    }
+    if(flags & kPressedColorFlag) {
+        widget->setProperty("pressedColor", QColor(Qt::transparent));
+    }
+    if(flags & kTextColorFlag) {
+        widget->setProperty("textColor", QColor());
+    }
+    if(flags & kClientFlag) {
+        widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBackground), QVariant());
+        widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderColor), QVariant());
+        widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth), QVariant());
+    }
+    widget->setProperty(kThemeIdProperty, QVariant());
+    widget->setProperty(kThemeFlagsProperty, QVariant());
+}
+
+/**
+ * @brief applyToWidget
+ * @note 按选择器优先级、再按文件中的顺序合并匹配的规则，后面的覆盖前面的，然后一次设置到控件上
+ */
+void applyToWidget(QWidget *widget, const Theme &theme, QVector<bool> &residualRules)
+{
+    QColor background, color, borderColor, hoverColor, pressedColor;
+    int borderWidth = -1;
+    ThemeRule::BorderStyle borderStyle = ThemeRule::kBorderUnset;
+    QString fontFamily;
+    qreal fontPointSize = -1;
+    int fontPixelSize = -1;
+
+    //rulesFor按文件中的顺序，稳定排序后优先级相同的仍保持文件中的顺序
+    const QVector<ThemeRule> &rules = theme.rules();
+    QVector<int> indexes = theme.rulesFor(widget->objectName());
+    std::stable_sort(indexes.begin(), indexes.end(), [&rules](int a, int b) {
+        return rules.at(a).specificity() < rules.at(b).specificity();
+    });
+    foreach(int index, indexes) {
+        const ThemeRule &rule = rules.at(index);
+        if(rule.isEmpty() || !rule.matches(widget)) {
+            continue;
+        }
+        if(needsStyleSheet(rule, widget)) {
+            residualRules[index] = true;
+            continue;
+        }
+        if(rule.pseudo == QLatin1String("hover")) {
+            hoverColor = rule.background;
+            continue;
+        }
+        if(rule.pseudo == QLatin1String("pressed")) {
+            pressedColor = rule.background;
+            continue;
+        }
+        if(rule.background.isValid()) background = rule.background;
+        if(rule.color.isValid()) color = rule.color;
+        if(rule.borderColor.isValid()) borderColor = rule.borderColor;
+        if(rule.borderWidth >= 0) borderWidth = rule.borderWidth;
+        if(rule.borderStyle != ThemeRule::kBorderUnset) borderStyle = rule.borderStyle;
+        if(!rule.fontFamily.isEmpty()) fontFamily = rule.fontFamily;
+        if(rule.fontPointSize > 0) {
+            fontPointSize = rule.fontPointSize;
+            fontPixelSize = -1;
+        }
+        if(rule.fontPixelSize > 0) {
+            fontPixelSize = rule.fontPixelSize;
+            fontPointSize = -1;
+        }
+    }
+
+    int flags = 0;
+    if(color.isValid()) {
+        QPalette palette = widget->palette();
+        palette.setColor(QPalette::WindowText, color);
+        palette.setColor(QPalette::Text, color);
+        palette.setColor(QPalette::ButtonText, color);
+        widget->setPalette(palette);
+        flags |= kPaletteFlag;
+        if(widget->metaObject()->indexOfProperty("textColor") >= 0) {
+            widget->setProperty("textColor", color);
+            flags |= kTextColorFlag;
+        }
+    }
+    if(!fontFamily.isEmpty() || fontPointSize > 0 || fontPixelSize > 0) {
+        QFont font = widget->font();
+        if(!fontFamily.isEmpty()) {
+            font.setFamily(fontFamily);
+        }
+        if(fontPointSize > 0) {
+            font.setPointSizeF(fontPointSize);
+        } else if(fontPixelSize > 0) {
+            font.setPixelSize(fontPixelSize);
+        }
+        widget->setFont(font);
+        flags |= kFontFlag;
+    }
+
+    const bool border = borderStyle == ThemeRule::kBorderSolid && borderWidth > 0 && borderColor.isValid();
+    if(widget->isWindow()) {
+        //needsStyleSheet只让自己绘制客户区的顶层窗口走到这里
+        if(background.isValid() || border) {
+            widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBackground),
+                                background.isValid() ? QVariant(background) : QVariant());
+            widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderColor),
+                                border ? QVariant(borderColor) : QVariant());
+            widget->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth), border ? borderWidth : 0);
+            flags |= kClientFlag;
+        }
+    } else if(background.isValid() || border) {
+        widget->setProperty(kBackgroundProperty, background.isValid() ? QVariant(background) : QVariant());
+        widget->setProperty(kBorderColorProperty, border ? QVariant(borderColor) : QVariant());
+        widget->setProperty(kBorderWidthProperty, border ? borderWidth : 0);
+        if(!widget->testAttribute(Qt::WA_StyledBackground)) {
+            widget->setAttribute(Qt::WA_StyledBackground);
+            flags |= kStyledAttributeFlag;
+        }
+        widget->setStyle(ThemeEngine::style());
+        flags |= kBackgroundFlag;
+    }
+    if(hoverColor.isValid()) {
+        widget->setProperty("hoverColor", hoverColor);
+        flags |= kHoverColorFlag;
+    }
+    if(pressedColor.isValid()) {
+        widget->setProperty("pressedColor", pressedColor);
+        flags |= kPressedColorFlag;
+    }
+
+    widget->setProperty(kThemeIdProperty, theme.id());
+    widget->setProperty(kThemeFlagsProperty, flags);
+
+    if(flags) {
+        ThemeCache *cache = s_themeCache();
+        QMutexLocker locker(&cache->mutex);
+        ++cache->statistics.themedWidgets;
+    }
+}
+
+void ThemeBinding::refresh()
+{
+    if(!m_theme) {
+        return;
+    }
+
+    QList<QWidget *> widgets = m_pWindow->findChildren<QWidget *>();
+    widgets.prepend(m_pWindow);
+    foreach(QWidget *widget, widgets) {
+        //只处理新建的、或者应用的是别的主题的控件
+        const QVariant themeId = widget->property(kThemeIdProperty);
+        if(themeId.toInt() == m_theme->id()) {
+            continue;
+        }
+        if(themeId.isValid()) {
+            resetWidget(widget);
+        }
+        applyToWidget(widget, *m_theme, m_residualRules);
+    }
+    updateStyleSheet();
+}
+
+void ThemeBinding::reset()
+{
+    QList<QWidget *> widgets = m_pWindow->findChildren<QWidget *>();
+    widgets.prepend(m_pWindow);
+    foreach(QWidget *widget, widgets) {
+        if(widget->property(kThemeIdProperty).isValid()) {
+            resetWidget(widget);
+        }
+    }
+    setTheme(QSharedPointer<const Theme>());
+    updateStyleSheet();
+}
+
+void ThemeBinding::updateStyleSheet()
+{
+    QString styleSheet;
+    if(m_theme) {
+        const QVector<ThemeRule> &rules = m_theme->rules();
+        for(int i = 0; i < m_residualRules.size(); ++i) {
+            if(m_residualRules.at(i)) {
+                styleSheet += rules.at(i).text;
+                styleSheet += QLatin1Char('\n');
+            }
+        }
+    }
+    if(styleSheet == m_residualStyleSheet) {
+        return;
+    }
+
+    //只有无法映射的规则匹配到控件时才启用样式表引擎
+    m_residualStyleSheet = styleSheet;
+    m_pWindow->setStyleSheet(styleSheet);
+    if(!styleSheet.isEmpty()) {
+        ThemeCache *cache = s_themeCache();
+        QMutexLocker locker(&cache->mutex);
+        ++cache->statistics.residualWindows;
+    }
+}
+
+} // namespace
+
+bool ThemeRule::isEmpty() const
+{
+    return !background.isValid() && !color.isValid() && !borderColor.isValid()
+            && borderWidth < 0 && borderStyle == kBorderUnset
+            && !hasFont() && unmapped.isEmpty();
+}
+
+bool ThemeRule::matches(const QWidget *widget) const
+{
+    if(!objectName.isEmpty() && widget->objectName() != objectName) {
+        return false;
+    }
+    if(type.isEmpty()) {
+        return true;
+    }
+    if(exactType) {
+        return type == QLatin1String(widget->metaObject()->className());
+    }
+    //样式表的类型选择器同样匹配子类
+    return widget->inherits(type.toLatin1().constData());
+}
+
+int ThemeRule::specificity() const
+{
+    int result = 0;
+    if(!objectName.isEmpty()) {
+        result += 100;
+    }
+    if(!attrName.isEmpty()) {
+        result += 10;
+    }
+    if(!pseudo.isEmpty()) {
+        result += 10;
+    }
+    if(!type.isEmpty()) {
+        result += 1;
+    }
+    return result;
+}
+
+Theme::Theme()
+    : m_nId(s_nextThemeId.fetchAndAddRelaxed(1))
+{
+}
+
+int Theme::residualRuleCount() const
+{
+    int count = 0;
+    foreach(const ThemeRule &rule, m_rules) {
+        if(!rule.unmapped.isEmpty() || (!rule.attrName.isEmpty() && !rule.isEmpty())) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+QVector<int> Theme::rulesFor(const QString &objectName) const
+{
+    const QVector<int> named = m_namedRules.value(objectName);
+    if(named.isEmpty()) {
+        return m_anonymousRules;
+    }
+
+    //两组下标都是递增的，合并后保持文件中的顺序
+    QVector<int> result;
+    result.reserve(named.size() + m_anonymousRules.size());
+    int i = 0, j = 0;
+    while(i < named.size() || j < m_anonymousRules.size()) {
+        if(j >= m_anonymousRules.size() || (i < named.size() && named.at(i) < m_anonymousRules.at(j))) {
+            result.append(named.at(i++));
+        } else {
+            result.append(m_anonymousRules.at(j++));
+        }
+    }
+    return result;
+}
+
+void Theme::parse(const QString &styleSheet)
+{
+    m_styleSheet = styleSheet;
+
+    QString text = stripComments(styleSheet);
+    if(text.startsWith(QChar(0xFEFF))) {
+        text.remove(0, 1);
+    }
+
+    int from = 0;
+    while(true) {
+        const int open = text.indexOf(QLatin1Char('{'), from);
+        if(open < 0) {
+            break;
+        }
+        const int close = text.indexOf(QLatin1Char('}'), open);
+        if(close < 0) {
+            break;
+        }
+        const QString selectors = text.mid(from, open - from);
+        const QString body = text.mid(open + 1, close - open - 1);
+        from = close + 1;
+
+        //声明按名称、值拆开，值中可能有冒号(url(:/...))
+        QVector<QPair<QString, QString> > declarations;
+        foreach(const QString &declaration, body.split(QLatin1Char(';'), QString::SkipEmptyParts)) {
+            const int colon = declaration.indexOf(QLatin1Char(':'));
+            if(colon <= 0) {
+                continue;
+            }
+            declarations.append(qMakePair(declaration.left(colon).trimmed().toLower(),
+                                          declaration.mid(colon + 1).trimmed()));
+        }
+
+        foreach(QString selector, selectors.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+            selector = selector.simplified();
+            ThemeRule rule;
+            rule.text = selector + QLatin1String(" {") + body + QLatin1Char('}');
+            rule.complexSelector = !parseSelector(selector, rule);
+            if(rule.complexSelector) {
+                parseSubject(selector, rule);
+            }
+            for(int i = 0; i < declarations.size(); ++i) {
+                if(rule.complexSelector) {
+                    rule.unmapped.append(declarations.at(i).first + QLatin1String(": ") + declarations.at(i).second);
+                } else {
+                    compileDeclaration(rule, declarations.at(i).first, declarations.at(i).second);
+                }
+            }
+
+            const int index = m_rules.size();
+            if(rule.objectName.isEmpty()) {
+                m_anonymousRules.append(index);
+            } else {
+                m_namedRules[rule.objectName].append(index);
+            }
+            m_rules.append(rule);
+        }
+    }
+}
+
+void Theme::parseSubject(const QString &selector, ThemeRule &rule)
+{
+    //最右边的复合选择器，如"QDialog QPushButton#ok:hover"中的"QPushButton#ok:hover"
+    static const QRegularExpression separator(QStringLiteral("[\\s>+~]+"));
+    static const QRegularExpression re(QStringLiteral(
+        "^(\\.)?(\\*|[A-Za-z_][A-Za-z0-9_-]*)?"
+        "(?:#([A-Za-z0-9_-]+))?"
+        "(?:\\[[^\\]]*\\])*"
+        "(?:::?!?[A-Za-z-]+)*$"));
+    const QStringList parts = selector.split(separator, QString::SkipEmptyParts);
+    const QRegularExpressionMatch match = re.match(parts.isEmpty() ? QString() : parts.last());
+    if(parts.isEmpty() || !match.hasMatch()) {
+        //无法解析时匹配任意控件，由样式表引擎决定
+        return;
+    }
+    rule.exactType = !match.captured(1).isEmpty();
+    rule.type = match.captured(2);
+    if(rule.type == QLatin1String("*")) {
+        rule.type.clear();
+    }
+    //样式表中命名空间写成ns--Class
+    rule.type.replace(QLatin1String("--"), QLatin1String("::"));
+    rule.objectName = match.captured(3);
+}
+
+void Theme::compileDeclaration(ThemeRule &rule, const QString &name, const QString &value)
+{
+    bool mapped = true;
+    if(name == QLatin1String("background-color") || name == QLatin1String("background")) {
+        rule.background = parseColor(value);
+        mapped = rule.background.isValid();
+    } else if(name == QLatin1String("color")) {
+        rule.color = parseColor(value);
+        mapped = rule.color.isValid();
+    } else if(name == QLatin1String("border")) {
+        //简写：none，或者宽度、线型、颜色的任意组合
+        foreach(const QString &token, value.split(QLatin1Char(' '), QString::SkipEmptyParts)) {
+            if(token == QLatin1String("none")) {
+                rule.borderStyle = ThemeRule::kBorderNone;
+            } else if(token == QLatin1String("solid")) {
+                rule.borderStyle = ThemeRule::kBorderSolid;
+            } else if(parsePixels(token) >= 0) {
+                rule.borderWidth = parsePixels(token);
+            } else if(parseColor(token).isValid()) {
+                rule.borderColor = parseColor(token);
+            } else {
+                mapped = false;
+            }
+        }
+    } else if(name == QLatin1String("border-style")) {
+        if(value == QLatin1String("none")) {
+            rule.borderStyle = ThemeRule::kBorderNone;
+        } else if(value == QLatin1String("solid")) {
+            rule.borderStyle = ThemeRule::kBorderSolid;
+        } else {
+            mapped = false;
+        }
+    } else if(name == QLatin1String("border-width")) {
+        rule.borderWidth = parsePixels(value);
+        mapped = rule.borderWidth >= 0;
+    } else if(name == QLatin1String("border-color")) {
+        rule.borderColor = parseColor(value);
+        mapped = rule.borderColor.isValid();
+    } else if(name == QLatin1String("font-family")) {
+        rule.fontFamily = unquote(value);
+    } else if(name == QLatin1String("font-size")) {
+        bool ok = false;
+        if(value.endsWith(QLatin1String("pt"))) {
+            rule.fontPointSize = value.left(value.size() - 2).toDouble(&ok);
+        } else {
+            rule.fontPixelSize = parsePixels(value);
+            ok = rule.fontPixelSize > 0;
+        }
+        mapped = ok;
+    } else if(name == QLatin1String("image")) {
+        //图片不存在时样式表引擎什么也不画，直接忽略；存在时交给样式表引擎
+        QString path = value;
+        if(path.startsWith(QLatin1String("url(")) && path.endsWith(QLatin1Char(')'))) {
+            path = unquote(path.mid(4, path.size() - 5));
+        }
+        mapped = !QFile::exists(path);
+    } else {
+        mapped = false;
+    }
+
+    if(!mapped) {
+        rule.unmapped.append(name + QLatin1String(": ") + value);
+    }
+}
+
+QSharedPointer<const Theme> ThemeEngine::theme(const QString &fileName)
+{
+    ThemeCache *cache = s_themeCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        QHash<QString, QSharedPointer<const Theme> >::const_iterator it = cache->themes.constFind(fileName);
+        if(it != cache->themes.constEnd()) {
+            ++cache->statistics.cacheHits;
+            return it.value();
+        }
+    }
+
+    //解析时不持有锁，两个线程同时解析同一个文件时保留先放入缓存的
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "ThemeEngine: cannot open" << fileName;
+        return QSharedPointer<const Theme>();
+    }
+    QSharedPointer<Theme> theme(new Theme());
+    theme->m_fileName = fileName;
+    theme->parse(QString::fromUtf8(file.readAll()));
+
+    QMutexLocker locker(&cache->mutex);
+    ++cache->statistics.parsedFiles;
+    QHash<QString, QSharedPointer<const Theme> >::const_iterator it = cache->themes.constFind(fileName);
+    if(it != cache->themes.constEnd()) {
+        return it.value();
+    }
+    cache->themes.insert(fileName, theme);
+    return theme;
+}
+
+QSharedPointer<const Theme> ThemeEngine::fromStyleSheet(const QString &styleSheet)
+{
+    QSharedPointer<Theme> theme(new Theme());
+    theme->parse(styleSheet);
+    return theme;
+}
+
+void ThemeEngine::apply(QWidget *window, const QSharedPointer<const Theme> &theme)
+{
+    if(!window) {
+        return;
+    }
+
+    ThemeBinding *binding = bindingOf(window);
+    if(!theme) {
+        if(binding) {
+            binding->reset();
+            delete binding;
+        }
+        return;
+    }
+
+    if(!binding) {
+        //不再使用setStyleSheetFile设置的样式表
+        if(!window->styleSheet().isEmpty()) {
+            window->setStyleSheet(QString());
+        }
+        binding = new ThemeBinding(window);
+    }
+    binding->setTheme(theme);
+    binding->refresh();
+}
+
+const char *ThemeEngine::clientProperty(ClientProperty property)
+{
+    return kClientProperties[property];
+}
+
+QStyle *ThemeEngine::style()
+{
+    if(!s_pThemeStyle) {
+        //没有指定基础样式，使用应用程序的样式
+        s_pThemeStyle = new ThemeStyle();
+        s_pThemeStyle->setParent(qApp);
+    }
+    return s_pThemeStyle;
+}
+
+ThemeStatistics ThemeEngine::statistics()
+{
+    ThemeCache *cache = s_themeCache();
+    QMutexLocker locker(&cache->mutex);
+    return cache->statistics;
+}
+
+void ThemeEngine::resetStatistics()
+{
+    ThemeCache *cache = s_themeCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->statistics = ThemeStatistics();
+}
+
+void ThemeEngine::clear()
+{
+    ThemeCache *cache = s_themeCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->themes.clear();
+}
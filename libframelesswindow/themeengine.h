@@ -0,0 +1,188 @@
+﻿/**
+ * 自定义无边框窗体、对话框和提示框并封装成库
+ *
+ * themeengine.h
+ * 编译后的主题：每个QSS文件只解析一次，所有无边框窗口共享，能映射的规则直接设置为调色板和属性。
+ *
+ */
+
+#ifndef THEMEENGINE_H
+#define THEMEENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QColor>
+#include <QHash>
+#include <QVector>
+#include <QSharedPointer>
+
+class QWidget;
+class QStyle;
+
+/**
+ * @brief The ThemeRule struct
+ *  一条QSS规则编译后的结果，选择器形如 Type#name[property=value]:state
+ */
+struct ThemeRule
+{
+    ThemeRule()
+        : complexSelector(false), exactType(false), borderWidth(-1), borderStyle(kBorderUnset), fontPointSize(-1), fontPixelSize(-1) {}
+
+    enum BorderStyle { kBorderUnset, kBorderNone, kBorderSolid };
+
+    QString type;           //类型选择器(C++类名)，空表示任意类型
+    QString objectName;     //#名称，空表示任意名称
+    QByteArray attrName;    //[属性=值]中的属性名，值可能在运行时改变
+    QString attrValue;
+    QString pseudo;         //:hover、:pressed等状态，空表示普通状态
+    QString text;           //原始的规则文字，不能映射时原样交给样式表引擎
+    bool complexSelector;   //后代、子控件等无法直接映射的选择器，匹配到控件时交给样式表引擎，
+                            //type、objectName取最右边的部分，不检查祖先，不能解析时匹配任意控件
+    bool exactType;         //.Type只匹配该类，不匹配子类
+
+    QColor background;
+    QColor color;
+    QColor borderColor;
+    int borderWidth;        //-1表示没有设置
+    BorderStyle borderStyle;
+    QString fontFamily;
+    qreal fontPointSize;    //-1表示没有设置
+    int fontPixelSize;      //-1表示没有设置
+    QStringList unmapped;   //不能映射的声明
+
+    bool hasBorder() const { return borderStyle == kBorderSolid && borderWidth > 0 && borderColor.isValid(); }
+    bool hasFont() const { return !fontFamily.isEmpty() || fontPointSize > 0 || fontPixelSize > 0; }
+    //是否有需要设置的内容，只有无效声明(如图片不存在的image)的规则可以跳过
+    bool isEmpty() const;
+    //类型和#名称是否匹配，[属性=值]的值和状态交给样式表引擎在运行时判断
+    bool matches(const QWidget *widget) const;
+    //和样式表一样的选择器优先级：#名称 > [属性]、:状态 > 类型，相同时文件中靠后的优先。
+    //复杂选择器只按最右边的部分计算，它们总是交给样式表引擎，不参与合并
+    int specificity() const;
+};
+
+/**
+ * @brief The Theme class
+ *  解析好的主题，只读，可以在多个窗口间共享
+ */
+class Theme
+{
+public:
+    //每个主题唯一的编号，控件记录自己应用过的主题
+    int id() const { return m_nId; }
+    QString fileName() const { return m_fileName; }
+    //原始的QSS文字
+    const QString &styleSheet() const { return m_styleSheet; }
+    const QVector<ThemeRule> &rules() const { return m_rules; }
+    //需要样式表引擎处理的规则个数
+    int residualRuleCount() const;
+
+    /**
+     * @brief rulesFor
+     * @note 可能匹配该名称控件的规则下标，按在文件中的先后顺序
+     */
+    QVector<int> rulesFor(const QString &objectName) const;
+
+private:
+    friend class ThemeEngine;
+    Theme();
+    void parse(const QString &styleSheet);
+    // 复杂选择器取最右边的部分用于匹配
+    static void parseSubject(const QString &selector, ThemeRule &rule);
+    void compileDeclaration(ThemeRule &rule, const QString &name, const QString &value);
+
+private:
+    int m_nId;
+    QString m_fileName;
+    QString m_styleSheet;
+    QVector<ThemeRule> m_rules;
+    QHash<QString, QVector<int> > m_namedRules;     //#名称 -> 规则下标
+    QVector<int> m_anonymousRules;                  //没有#名称的规则
+};
+
+/**
+ * @brief The ThemeStatistics struct
+ *  主题解析和应用统计，用于确认同一个文件只解析一次
+ */
+struct ThemeStatistics
+{
+    ThemeStatistics()
+        : parsedFiles(0), cacheHits(0), themedWidgets(0), residualWindows(0) {}
+
+    int parsedFiles;        //解析过的文件次数
+    int cacheHits;          //直接使用缓存的次数
+    qint64 themedWidgets;   //设置过调色板、字体或属性的控件数
+    qint64 residualWindows; //仍需要设置样式表的窗口次数
+};
+
+/**
+ * @brief The ThemeEngine class
+ *  setStyleSheetFile让每个窗口都读文件并由样式表引擎解析，
+ *  并且每个子控件都要经过QStyleSheetStyle的polish。ThemeEngine把文件解析一次后缓存，
+ *  按对象名直接设置：
+ *   - color、font-family、font-size -> 调色板和字体
+ *   - 普通控件的background-color、border -> ThemeEngine::style()绘制的PE_Widget背景
+ *   - 顶层窗口的background-color、border -> clientProperty()属性，由WidgetShadow画在客户区
+ *   - 按钮:hover、:pressed的背景 -> hoverColor、pressedColor属性，
+ *     只用于原生绘制(StateButton::setNativeRendering)创建的StateButton、TextButton
+ *   - 图片不存在的image -> 忽略，样式表引擎同样什么也不画
+ *  匹配的规则按选择器优先级、再按文件中的顺序合并。
+ *  其余规则(包括非WidgetShadow顶层窗口的背景和边框、非原生绘制按钮的状态背景)只有在窗口中有控件匹配时，
+ *  才拼成样式表设置到该窗口上，显示效果与setStyleSheetFile相同。
+ *  窗口每次显示时给新建的子控件补上主题。只能在GUI线程使用
+ */
+class ThemeEngine
+{
+public:
+    enum ClientProperty {
+        ClientPainting = 0,     //顶层窗口设为true，表示客户区背景和边框由窗口自己绘制
+        ClientBackground,       //QColor，没有设置时无效
+        ClientBorderColor,      //QColor，没有边框时无效
+        ClientBorderWidth       //int
+    };
+
+    /**
+     * @brief clientProperty
+     * @note 自己绘制客户区的顶层窗口(WidgetShadow)使用的动态属性名。
+     *  主题中这类窗口的背景和边框设置到这些属性上，窗口在QEvent::DynamicPropertyChange中重画客户区
+     */
+    static const char *clientProperty(ClientProperty property);
+
+    /**
+     * @brief theme
+     * @note 读取并解析主题文件，同一个文件只解析一次，失败时返回空指针
+     */
+    static QSharedPointer<const Theme> theme(const QString &fileName);
+
+    /**
+     * @brief fromStyleSheet
+     * @note 解析一段QSS文字，不缓存
+     */
+    static QSharedPointer<const Theme> fromStyleSheet(const QString &styleSheet);
+
+    /**
+     * @brief apply
+     * @note 把主题应用到窗口及其所有子控件，并在窗口显示时给之后创建的子控件补上。
+     *  第一次应用时清除窗口原来的样式表(setStyleSheetFile设置的)，theme为空时恢复默认
+     */
+    static void apply(QWidget *window, const QSharedPointer<const Theme> &theme);
+
+    /**
+     * @brief style
+     * @note 绘制主题背景和边框的代理样式，所有窗口共享
+     */
+    static QStyle *style();
+
+    static ThemeStatistics statistics();
+    static void resetStatistics();
+
+    /**
+     * @brief clear
+     * @note 清空解析缓存，已应用的窗口仍持有各自的主题。
+     *  theme()和WidgetShadow::setStyleSheetFile、setTheme使用缓存的文件内容，不会发现文件被修改，
+     *  修改主题文件后调用clear()，之后再设置主题时重新读取
+     */
+    static void clear();
+};
+
+#endif // THEMEENGINE_H
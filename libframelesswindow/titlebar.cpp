@@ -7,6 +7,8 @@
  */
 
 #include "titlebar.h"
+#include "screentracker.h"
+#include "litetitlebar.h"
 #include <QLabel>
 #include <QPushButton>
 #include <QHBoxLayout>
@@ -15,21 +17,72 @@
 #include <QApplication>
 #include <qt_windows.h>
 #include <QDesktopWidget>
+#include <QStyle>
 
-TitleBar::TitleBar(QWidget *parent)
+namespace {
+
+AbstractTitleBar::Type s_defaultType = AbstractTitleBar::kStandardTitleBar;
+
+} // namespace
+
+AbstractTitleBar::AbstractTitleBar(QWidget *parent)
     : QWidget(parent)
+{
+}
+
+void AbstractTitleBar::setDefaultType(Type type)
+{
+    s_defaultType = type;
+}
+
+AbstractTitleBar::Type AbstractTitleBar::defaultType()
+{
+    return s_defaultType;
+}
+
+AbstractTitleBar *AbstractTitleBar::create(QWidget *parent)
+{
+    if(s_defaultType == kLiteTitleBar) {
+        return new LiteTitleBar(parent);
+    }
+    return new TitleBar(parent);
+}
+
+void AbstractTitleBar::toggleMaximize()
+{
+    QWidget *pWindow = this->window();
+    if(!pWindow->isTopLevel()) {
+        return;
+    }
+
+    if(pWindow->isMaximized()) {
+        pWindow->showNormal();
+    } else {
+        pWindow->showMaximized();
+        //最大化到窗口所在的屏幕
+        if(!m_pScreenTracker) {
+            m_pScreenTracker = ScreenTracker::find(pWindow);
+        }
+        pWindow->setGeometry(m_pScreenTracker ? m_pScreenTracker->availableGeometry()
+                             : QApplication::desktop()->availableGeometry(pWindow));
+    }
+}
+
+TitleBar::TitleBar(QWidget *parent)
+    : AbstractTitleBar(parent)
     , m_bMaximizeDisabled(false)
+    , m_maximizeState(kMaximizeUnknown)
 {
     setFixedHeight(30);
 
     m_pIconLabel = new QLabel(this);
     m_pTitleLabel = new QLabel(this);
     m_pMinimizeButton = new StateButton(this);
-    m_pMinimizeButton->setPixmap(QPixmap(":/images/titlebar/min.png"));
+    m_pMinimizeButton->loadIcon(IconAtlas::Minimize);
     m_pMaximizeButton = new StateButton(this);
-    m_pMaximizeButton->setPixmap(QPixmap(":/images/titlebar/max.png"));
+    m_pMaximizeButton->loadIcon(IconAtlas::Maximize);
     m_pCloseButton = new StateButton(this);
-    m_pCloseButton->setPixmap(QPixmap(":/images/titlebar/close.png"));
+    m_pCloseButton->loadIcon(IconAtlas::Close);
 
     m_pIconLabel->setFixedSize(20, 20);
     m_pIconLabel->setScaledContents(true);
@@ -88,6 +141,11 @@ void TitleBar::hideTitleIcon()
     m_pIconLabel->setVisible(false);
 }
 
+void TitleBar::showTitleIcon()
+{
+    m_pIconLabel->setVisible(true);
+}
+
 void TitleBar::mouseDoubleClickEvent(QMouseEvent *event)
 {
     Q_UNUSED(event);
@@ -132,10 +190,13 @@ bool TitleBar::eventFilter(QObject *obj, QEvent *event)
         }
     }
     case QEvent::Move:
+        //移动不会改变最大化状态
+        return false;
     case QEvent::WindowStateChange:
     case QEvent::Resize:
         updateMaximize();
-        return true;
+        //不拦截，宿主窗口的resizeEvent还要重建背景和遮罩
+        return false;
     default:
         return QWidget::eventFilter(obj, event);
     }
@@ -149,14 +210,8 @@ void TitleBar::onClicked()
         if(pButton == m_pMinimizeButton) {
             pWindow->showMinimized();
         } else if(pButton == m_pMaximizeButton) {
-            if(pWindow->isMaximized()) {
-                pWindow->showNormal();
-                m_pMaximizeButton->setPixmap(QPixmap(":/images/titlebar/max.png"));
-            } else {
-                pWindow->showMaximized();
-                window()->setGeometry(QApplication::desktop()->availableGeometry());
-                m_pMaximizeButton->setPixmap(QPixmap(":/images/titlebar/restore.png"));
-            }
+            toggleMaximize();
+            updateMaximize();
         } else if(pButton == m_pCloseButton) {
             pWindow->close();
         }
@@ -167,15 +222,35 @@ void TitleBar::updateMaximize()
 {
     QWidget *pWindow = this->window();
     if(pWindow->isTopLevel()) {
-        bool bMaximize = pWindow->isMaximized();
-        if(bMaximize) {
+        const MaximizeState state = pWindow->isMaximized() ? kMaximized : kNormal;
+        //只在最大化状态切换时更新，拖动窗口时不重复刷新样式
+        if(state == m_maximizeState) {
+            return;
+        }
+        m_maximizeState = state;
+
+        if(state == kMaximized) {
             m_pMaximizeButton->setToolTip(tr("Restore"));
             m_pMaximizeButton->setProperty("maximizeProperty", "restore");
+            m_pMaximizeButton->loadIcon(IconAtlas::Restore);
         } else {
             m_pMaximizeButton->setProperty("maximizeProperty", "maximize");
             m_pMaximizeButton->setToolTip(tr("Maximize"));
+            m_pMaximizeButton->loadIcon(IconAtlas::Maximize);
         }
 
-        m_pMaximizeButton->setStyle(QApplication::style());
+        repolish(m_pMaximizeButton);
+    }
+}
+
+void TitleBar::repolish(QWidget *pWidget)
+{
+    //动态属性改变后只需要样式表重新匹配这一个控件，
+    //没有样式表时属性不影响外观，不需要重新polish
+    QStyle *pStyle = pWidget->style();
+    if(pStyle->inherits("QStyleSheetStyle")) {
+        pStyle->unpolish(pWidget);
+        pStyle->polish(pWidget);
     }
+    pWidget->update();
 }
@@ -12,20 +12,71 @@
 #include <QWidget>
 #include <statebutton.h>
 #include <QHBoxLayout>
+#include <QPointer>
 
 class QLabel;
 class QPushButton;
-class TitleBar : public QWidget
+class ScreenTracker;
+
+/**
+ * @brief The AbstractTitleBar class
+ *  标题栏的公共接口。宿主窗口把自己的事件转发给标题栏(installEventFilter)，
+ *  标题栏据此更新标题、图标和最大化按钮
+ */
+class AbstractTitleBar : public QWidget
+{
+    Q_OBJECT
+public:
+    enum Type {
+        kStandardTitleBar = 0,  //图标、标题、按钮各是一个控件(默认)
+        kLiteTitleBar           //单个控件，自己绘制图标、标题和按钮
+    };
+
+    explicit AbstractTitleBar(QWidget *parent = nullptr);
+
+    /**
+     * @brief setDefaultType
+     * @note 之后创建的无边框窗体使用的标题栏类型，大量短时间存在的工具窗口可以使用kLiteTitleBar
+     * @param type
+     */
+    static void setDefaultType(Type type);
+    static Type defaultType();
+
+    /**
+     * @brief create
+     * @note 按默认类型创建标题栏
+     */
+    static AbstractTitleBar *create(QWidget *parent);
+
+    virtual void setMinimumVisible(bool minimum) = 0;
+    virtual void setMaximumVisible(bool maximum) = 0;
+    virtual void setMaximizeDisabled() = 0;
+    virtual void hideTitleIcon() = 0;
+    virtual void showTitleIcon() = 0;
+
+protected:
+    /**
+     * @brief toggleMaximize
+     * @note 最大化/还原宿主窗口，最大化到窗口所在屏幕的可用区域
+     */
+    void toggleMaximize();
+
+private:
+    QPointer<ScreenTracker> m_pScreenTracker;
+};
+
+class TitleBar : public AbstractTitleBar
 {
     Q_OBJECT
 public:
     explicit TitleBar(QWidget *parent = nullptr);
     ~TitleBar();
 
-    void setMinimumVisible(bool minimum);
-    void setMaximumVisible(bool maximum);
-    void setMaximizeDisabled();
-    void hideTitleIcon();
+    virtual void setMinimumVisible(bool minimum);
+    virtual void setMaximumVisible(bool maximum);
+    virtual void setMaximizeDisabled();
+    virtual void hideTitleIcon();
+    virtual void showTitleIcon();
 
 protected:
     /**
@@ -64,7 +115,20 @@ private:
      */
     void updateMaximize();
 
+    /**
+     * @brief repolish
+     * @note 动态属性改变后重新匹配样式表，代替setStyle
+     * @param pWidget
+     */
+    void repolish(QWidget *pWidget);
+
 private:
+    enum MaximizeState {
+        kMaximizeUnknown = 0,
+        kNormal,
+        kMaximized
+    };
+
     QHBoxLayout *m_pMainLayout;
     QLabel *m_pIconLabel;
     QLabel *m_pTitleLabel;
@@ -72,6 +136,7 @@ private:
     StateButton *m_pMaximizeButton;
     StateButton *m_pCloseButton;
     bool m_bMaximizeDisabled;
+    MaximizeState m_maximizeState;  // 上一次更新按钮时的最大化状态
 };
 
 #endif // TITLEBAR_H
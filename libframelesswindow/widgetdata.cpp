@@ -8,12 +8,18 @@
 
 #include "widgetdata.h"
 #include "framelesshelperprivate.h"
-#include "cursorposcalculator.h"
+#include "framelesshelper.h"
+#include "inputtrace.h"
+#include "frameprofiler.h"
 #include <QEvent>
 #include <QMouseEvent>
 #include <QRubberBand>
 #include <QPoint>
 #include <QDesktopWidget>
+#include <QTimer>
+#include <QWindow>
+#include <QScreen>
+#include <QGuiApplication>
 #include <QDebug>
 
 WidgetData::WidgetData(FramelessHelperPrivate *_d, QWidget *pTopLevelWidget)
@@ -22,18 +28,46 @@ WidgetData::WidgetData(FramelessHelperPrivate *_d, QWidget *pTopLevelWidget)
     m_pWidget = pTopLevelWidget;
     m_bLeftButtonPressed = false;
     m_bCursorShapeChanged = false;
+    m_cursorShape = Qt::ArrowCursor;
+    m_cursorRegion = HitTester::Client;
+    m_bMaximizedOrFullScreen = false;
+    m_bFrameStateValid = false;
     m_bLeftButtonTitlePressed = false;
     m_pRubberBand = NULL;
+    m_pressedRegion = HitTester::Client;
+    m_hitTester.setBorderWidth(d->m_nBorderWidth);
+    m_hitTester.setTitleHeight(d->m_nTitleHeight);
+    m_bResizePending = false;
+    m_nResizeInterval = 0;
+    m_bLastMovePosValid = false;
+    m_statisticsClock.start();
+    m_pFrameProfiler = NULL;
+
+    m_pResizeTimer = new QTimer(this);
+    m_pResizeTimer->setSingleShot(true);
+    m_pResizeTimer->setTimerType(Qt::PreciseTimer);
+    QObject::connect(m_pResizeTimer, &QTimer::timeout, this, [this]() {
+        flushPendingResize();
+    });
+
+    m_bLiveResizing = false;
+    m_pSettleTimer = new QTimer(this);
+    m_pSettleTimer->setSingleShot(true);
+    QObject::connect(m_pSettleTimer, &QTimer::timeout, this, [this]() {
+        endLiveResize();
+    });
 
     m_windowFlags = m_pWidget->windowFlags();
     m_pWidget->setMouseTracking(true);
     m_pWidget->setAttribute(Qt::WA_Hover, true);
+    m_pWidget->installEventFilter(this);
 
     updateRubberBandStatus();
 }
 
 WidgetData::~WidgetData()
 {
+    m_pWidget->removeEventFilter(this);
     m_pWidget->setMouseTracking(false);
     m_pWidget->setWindowFlags(m_windowFlags);
     m_pWidget->setAttribute(Qt::WA_Hover, false);
@@ -47,8 +81,70 @@ QWidget *WidgetData::widget()
     return m_pWidget;
 }
 
+HitTester *WidgetData::hitTester()
+{
+    return &m_hitTester;
+}
+
+FramelessEventStatistics WidgetData::eventStatistics() const
+{
+    FramelessEventStatistics statistics = m_eventStatistics;
+    statistics.elapsed = m_statisticsClock.elapsed();
+    return statistics;
+}
+
+void WidgetData::resetEventStatistics()
+{
+    m_eventStatistics = FramelessEventStatistics();
+    m_statisticsClock.restart();
+}
+
+void WidgetData::setFrameProfiler(FrameProfiler *profiler)
+{
+    m_pFrameProfiler = profiler;
+}
+
+bool WidgetData::eventFilter(QObject *watched, QEvent *event)
+{
+    if(watched != m_pWidget) {
+        return QObject::eventFilter(watched, event);
+    }
+
+    switch(event->type()) {
+    case QEvent::MouseMove:
+    case QEvent::HoverMove:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::Leave:
+        if(d->m_pTraceRecorder) {
+            d->m_pTraceRecorder->record(m_pWidget, event);
+        }
+        handleWidgetEvent(event);
+        return true;
+
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::WindowStateChange:
+        // 鼠标不动而窗体变化时，同一位置的鼠标样式可能不同
+        m_bLastMovePosValid = false;
+        m_bFrameStateValid = false;
+        break;
+
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+HitTester::Region WidgetData::hitTest(const QPoint &gMousePos, const QRect &frameRect) const
+{
+    return m_hitTester.hitTest(gMousePos - frameRect.topLeft(), frameRect.size());
+}
+
 void WidgetData::handleWidgetEvent(QEvent *event)
 {
+    ++m_eventStatistics.handled;
+
     switch(event->type()) {
     case QEvent::MouseButtonPress:
         handleMousePressEvent(static_cast<QMouseEvent *>(event));
@@ -63,11 +159,11 @@ void WidgetData::handleWidgetEvent(QEvent *event)
         break;
 
     case QEvent::Leave:
-        handleLeaveEvent(static_cast<QMouseEvent *>(event));
+        handleLeaveEvent(event);
         break;
 
     case QEvent::HoverMove:
-        handleHoverMoveEvent(static_cast<QMouseEvent *>(event));
+        handleHoverMoveEvent(static_cast<QHoverEvent *>(event));
         break;
 
     default:
@@ -90,16 +186,22 @@ void WidgetData::handleMousePressEvent(QMouseEvent *event)
 {
     if(event->button() == Qt::LeftButton) {
         m_bLeftButtonPressed = true;
-        m_bLeftButtonTitlePressed = event->pos().y() < m_moveMousePos.m_nTitleHeight;
-
+        m_bLastMovePosValid = false;
         QRect frameRect = m_pWidget->frameGeometry();
-        m_pressedMousePos.recalculate(event->globalPos(), frameRect);
+        m_pressedRegion = hitTest(event->globalPos(), frameRect);
+        m_bLeftButtonTitlePressed = (m_pressedRegion == HitTester::Caption);
 
         m_ptDragPos = event->globalPos() - frameRect.topLeft();
         m_dLeftScale = double(m_ptDragPos.x()) / double(frameRect.width());
         m_nRightLength = frameRect.width() - m_ptDragPos.x();
 
-        if(m_pressedMousePos.m_bOnEdges) {
+        m_bResizePending = false;
+        m_resizeClock.invalidate();
+        if(d->m_bResizeCoalescing) {
+            m_nResizeInterval = resizeFrameInterval();
+        }
+
+        if(HitTester::isEdge(m_pressedRegion)) {
             if(d->m_bRubberBandOnResize) {
                 m_pRubberBand->setGeometry(frameRect);
                 m_pRubberBand->show();
@@ -114,9 +216,13 @@ void WidgetData::handleMousePressEvent(QMouseEvent *event)
 void WidgetData::handleMouseReleaseEvent(QMouseEvent *event)
 {
     if(event->button() == Qt::LeftButton) {
+        // 松开前先应用最后一次缩放，保证最终大小与不合并时一致
+        flushPendingResize();
+        endLiveResize();
         m_bLeftButtonPressed = false;
         m_bLeftButtonTitlePressed = false;
-        m_pressedMousePos.reset();
+        m_pressedRegion = HitTester::Client;
+        m_bLastMovePosValid = false;
         if(m_pRubberBand && m_pRubberBand->isVisible()) {
             m_pRubberBand->hide();
             m_pWidget->setGeometry(m_pRubberBand->geometry());
@@ -127,64 +233,121 @@ void WidgetData::handleMouseReleaseEvent(QMouseEvent *event)
 void WidgetData::handleMouseMoveEvent(QMouseEvent *event)
 {
     if(m_bLeftButtonPressed) {
-        if(d->m_bWidgetResizable && m_pressedMousePos.m_bOnEdges) {
-            resizeWidget(event->globalPos());
+        if(d->m_bWidgetResizable && HitTester::isEdge(m_pressedRegion)) {
+            if(d->m_bResizeCoalescing) {
+                coalesceResize(event->globalPos());
+            } else {
+                resizeWidget(event->globalPos());
+            }
         } else if(d->m_bWidgetMovable && m_bLeftButtonTitlePressed) {
             moveWidget(event->globalPos());
         }
-    } else if(d->m_bWidgetResizable) {
+    } else if(d->m_bWidgetResizable && !isDuplicateMove(event->globalPos())) {
         updateCursorShape(event->globalPos());
     }
 }
 
-void WidgetData::handleLeaveEvent(QMouseEvent *event)
+void WidgetData::handleLeaveEvent(QEvent *event)
 {
     Q_UNUSED(event)
+    m_bLastMovePosValid = false;
     if(!m_bLeftButtonPressed) {
-        m_pWidget->unsetCursor();
+        applyCursorRegion(HitTester::Client);
     }
 }
 
-void WidgetData::handleHoverMoveEvent(QMouseEvent *event)
+void WidgetData::handleHoverMoveEvent(QHoverEvent *event)
 {
     if(d->m_bWidgetResizable) {
-        updateCursorShape(m_pWidget->mapToGlobal(event->pos()));
+        const QPoint gMousePos = m_pWidget->mapToGlobal(event->pos());
+        if(!isDuplicateMove(gMousePos)) {
+            updateCursorShape(gMousePos);
+        }
+    }
+}
+
+bool WidgetData::isDuplicateMove(const QPoint &gMousePos)
+{
+    // MouseMove和HoverMove成对到达，后到的一个不再计算鼠标样式
+    if(m_bLastMovePosValid && m_ptLastMovePos == gMousePos) {
+        ++m_eventStatistics.deduplicated;
+        return true;
+    }
+    m_ptLastMovePos = gMousePos;
+    m_bLastMovePosValid = true;
+    return false;
+}
+
+void WidgetData::updateFrameState()
+{
+    if(!m_bFrameStateValid) {
+        m_frameRect = m_pWidget->frameGeometry();
+        m_bMaximizedOrFullScreen = m_pWidget->isFullScreen() || m_pWidget->isMaximized();
+        m_bFrameStateValid = true;
     }
 }
 
 void WidgetData::updateCursorShape(const QPoint &gMousePos)
 {
-    if(m_pWidget->isFullScreen() || m_pWidget->isMaximized()) {
-        if(m_bCursorShapeChanged) {
-            m_pWidget->unsetCursor();
-        }
+    updateFrameState();
+    if(m_bMaximizedOrFullScreen) {
+        applyCursorRegion(HitTester::Client);
         return;
     }
 
-    m_moveMousePos.recalculate(gMousePos, m_pWidget->frameGeometry());
-
-    if(m_moveMousePos.m_bOnTopLeftEdge || m_moveMousePos.m_bOnBottomRightEdge) {
-        m_pWidget->setCursor(Qt::SizeFDiagCursor);
-        m_bCursorShapeChanged = true;
-    } else if(m_moveMousePos.m_bOnTopRightEdge || m_moveMousePos.m_bOnBottomLeftEdge) {
-        m_pWidget->setCursor(Qt::SizeBDiagCursor);
-        m_bCursorShapeChanged = true;
-    } else if(m_moveMousePos.m_bOnLeftEdge || m_moveMousePos.m_bOnRightEdge) {
-        m_pWidget->setCursor(Qt::SizeHorCursor);
-        m_bCursorShapeChanged = true;
-    } else if(m_moveMousePos.m_bOnTopEdge || m_moveMousePos.m_bOnBottomEdge) {
-        m_pWidget->setCursor(Qt::SizeVerCursor);
-        m_bCursorShapeChanged = true;
-    } else {
+    applyCursorRegion(hitTest(gMousePos, m_frameRect));
+}
+
+void WidgetData::applyCursorRegion(HitTester::Region region)
+{
+    if(!HitTester::isEdge(region)) {
+        region = HitTester::Client;
+    }
+    if(region == m_cursorRegion) {
+        return;
+    }
+    m_cursorRegion = region;
+
+    Qt::CursorShape shape;
+    switch(region) {
+    case HitTester::TopLeft:
+    case HitTester::BottomRight:
+        shape = Qt::SizeFDiagCursor;
+        break;
+    case HitTester::TopRight:
+    case HitTester::BottomLeft:
+        shape = Qt::SizeBDiagCursor;
+        break;
+    case HitTester::Left:
+    case HitTester::Right:
+        shape = Qt::SizeHorCursor;
+        break;
+    case HitTester::Top:
+    case HitTester::Bottom:
+        shape = Qt::SizeVerCursor;
+        break;
+    default:
         if(m_bCursorShapeChanged) {
             m_pWidget->unsetCursor();
             m_bCursorShapeChanged = false;
+            ++m_eventStatistics.cursorChanges;
         }
+        return;
+    }
+
+    // 对角的两个区域样式相同，区域变了样式不一定变
+    if(m_bCursorShapeChanged && m_cursorShape == shape) {
+        return;
     }
+    m_pWidget->setCursor(shape);
+    m_cursorShape = shape;
+    m_bCursorShapeChanged = true;
+    ++m_eventStatistics.cursorChanges;
 }
 
 void WidgetData::resizeWidget(const QPoint &gMousePos)
 {
+    FrameProfilerScope profile(m_pFrameProfiler, FrameProfiler::HelperResize);
     QRect origRect;
 
     if(d->m_bRubberBandOnResize)
@@ -201,26 +364,37 @@ void WidgetData::resizeWidget(const QPoint &gMousePos)
     int minWidth = m_pWidget->minimumWidth();
     int minHeight = m_pWidget->minimumHeight();
 
-    if(m_pressedMousePos.m_bOnTopLeftEdge) {
+    switch(m_pressedRegion) {
+    case HitTester::TopLeft:
         left = gMousePos.x();
         top = gMousePos.y();
-    } else if(m_pressedMousePos.m_bOnBottomLeftEdge) {
+        break;
+    case HitTester::BottomLeft:
         left = gMousePos.x();
         bottom = gMousePos.y();
-    } else if(m_pressedMousePos.m_bOnTopRightEdge) {
+        break;
+    case HitTester::TopRight:
         right = gMousePos.x();
         top = gMousePos.y();
-    } else if(m_pressedMousePos.m_bOnBottomRightEdge) {
+        break;
+    case HitTester::BottomRight:
         right = gMousePos.x();
         bottom = gMousePos.y();
-    } else if(m_pressedMousePos.m_bOnLeftEdge) {
+        break;
+    case HitTester::Left:
         left = gMousePos.x();
-    } else if(m_pressedMousePos.m_bOnRightEdge) {
+        break;
+    case HitTester::Right:
         right = gMousePos.x();
-    } else if(m_pressedMousePos.m_bOnTopEdge) {
+        break;
+    case HitTester::Top:
         top = gMousePos.y();
-    } else if(m_pressedMousePos.m_bOnBottomEdge) {
+        break;
+    case HitTester::Bottom:
         bottom = gMousePos.y();
+        break;
+    default:
+        break;
     }
 
     QRect newRect(QPoint(left, top), QPoint(right, bottom));
@@ -242,13 +416,76 @@ void WidgetData::resizeWidget(const QPoint &gMousePos)
         if(d->m_bRubberBandOnResize) {
             m_pRubberBand->setGeometry(newRect);
         } else {
+            beginLiveResize();
             m_pWidget->setGeometry(newRect);
         }
     }
 }
 
+void WidgetData::coalesceResize(const QPoint &gMousePos)
+{
+    m_ptPendingResizePos = gMousePos;
+    m_bResizePending = true;
+
+    const qint64 elapsed = m_resizeClock.isValid() ? m_resizeClock.elapsed() : m_nResizeInterval;
+    if(elapsed >= m_nResizeInterval) {
+        flushPendingResize();
+    } else if(!m_pResizeTimer->isActive()) {
+        m_pResizeTimer->start(m_nResizeInterval - int(elapsed));
+    }
+}
+
+void WidgetData::flushPendingResize()
+{
+    m_pResizeTimer->stop();
+    if(!m_bResizePending) {
+        return;
+    }
+
+    m_bResizePending = false;
+    m_resizeClock.start();
+    resizeWidget(m_ptPendingResizePos);
+}
+
+int WidgetData::resizeFrameInterval() const
+{
+    if(d->m_nResizeFrameInterval > 0) {
+        return d->m_nResizeFrameInterval;
+    }
+
+    QWindow *pWindow = m_pWidget->windowHandle();
+    QScreen *pScreen = pWindow ? pWindow->screen() : QGuiApplication::primaryScreen();
+    qreal rate = pScreen ? pScreen->refreshRate() : 0;
+    if(rate <= 0) {
+        rate = 60;
+    }
+    return qMax(1, qRound(1000.0 / rate));
+}
+
+void WidgetData::beginLiveResize()
+{
+    if(!m_bLiveResizing) {
+        m_bLiveResizing = true;
+        emit d->q->liveResizeChanged(m_pWidget, true);
+    }
+
+    if(d->m_nLiveResizeSettleInterval > 0) {
+        m_pSettleTimer->start(d->m_nLiveResizeSettleInterval);
+    }
+}
+
+void WidgetData::endLiveResize()
+{
+    m_pSettleTimer->stop();
+    if(m_bLiveResizing) {
+        m_bLiveResizing = false;
+        emit d->q->liveResizeChanged(m_pWidget, false);
+    }
+}
+
 void WidgetData::moveWidget(const QPoint &gMousePos)
 {
+    FrameProfilerScope profile(m_pFrameProfiler, FrameProfiler::HelperMove);
     if(d->m_bRubberBandOnMove) {
         m_pRubberBand->move(gMousePos - m_ptDragPos);
     } else {
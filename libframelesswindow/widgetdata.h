@@ -2,17 +2,47 @@
 #define WIDGETDATA_H
 #include <QObject>
 #include <QPoint>
-#include "cursorposcalculator.h"
+#include <QRect>
+#include <QElapsedTimer>
+#include "hittester.h"
 
 class FramelessHelperPrivate;
-class CursorPosCalculator;
 class QWidget;
 class QEvent;
 class QMouseEvent;
+class QHoverEvent;
 class QRubberBand;
 class QPoint;
+class QTimer;
+class FrameProfiler;
 
-class WidgetData
+/**
+ * @brief The FramelessEventStatistics struct
+ *  鼠标事件统计。同一次鼠标移动会同时产生MouseMove和HoverMove，
+ *  deduplicated记录其中被合并、没有再次计算鼠标样式的事件数；
+ *  cursorChanges记录真正调用setCursor/unsetCursor的次数
+ */
+struct FramelessEventStatistics
+{
+    FramelessEventStatistics()
+        : handled(0), deduplicated(0), cursorChanges(0), elapsed(0) {}
+
+    qint64 handled;       //处理的鼠标事件数
+    qint64 deduplicated;  //被合并的重复移动事件数
+    qint64 cursorChanges; //改变鼠标样式的次数
+    qint64 elapsed;       //统计开始至今的毫秒数
+
+    qreal cursorChangesPerSecond() const
+    {
+        return elapsed > 0 ? cursorChanges * 1000.0 / elapsed : 0.0;
+    }
+};
+
+/**
+ * @brief The WidgetData class
+ *  直接安装在窗体上的事件过滤器，分发鼠标事件时不需要再按窗体查找
+ */
+class WidgetData : public QObject
 {
 public:
     explicit WidgetData(FramelessHelperPrivate *_d, QWidget *pTopLevelWidget);
@@ -23,6 +53,16 @@ public:
     void handleWidgetEvent(QEvent *event);
     // 更新橡皮筋状态
     void updateRubberBandStatus();
+    // 窗体的命中测试
+    HitTester *hitTester();
+    // 鼠标事件统计
+    FramelessEventStatistics eventStatistics() const;
+    void resetEventStatistics();
+    // 移动、缩放耗时记录到profiler
+    void setFrameProfiler(FrameProfiler *profiler);
+
+protected:
+    virtual bool eventFilter(QObject *watched, QEvent *event);
 
 private:
     // 处理鼠标按下
@@ -32,16 +72,34 @@ private:
     // 处理鼠标移动
     void handleMouseMoveEvent(QMouseEvent *event);
     // 处理鼠标离开
-    void handleLeaveEvent(QMouseEvent *event);
+    void handleLeaveEvent(QEvent *event);
     // 处理鼠标进入
-    void handleHoverMoveEvent(QMouseEvent *event);
+    void handleHoverMoveEvent(QHoverEvent *event);
 
+    // 鼠标全局位置所在的区域
+    HitTester::Region hitTest(const QPoint &gMousePos, const QRect &frameRect) const;
+    // 同一位置的移动已经处理过时返回true
+    bool isDuplicateMove(const QPoint &gMousePos);
     // 更新鼠标样式
     void updateCursorShape(const QPoint &gMousePos);
+    // 切换到区域对应的鼠标样式，样式不变时不调用setCursor
+    void applyCursorRegion(HitTester::Region region);
+    // 缓存的窗体位置和最大化状态，Move/Resize/WindowStateChange时失效
+    void updateFrameState();
     // 重置窗口大小
     void resizeWidget(const QPoint &gMousePos);
     // 移动窗体
     void moveWidget(const QPoint &gMousePos);
+    // 合并缩放，每个帧间隔最多调用一次resizeWidget
+    void coalesceResize(const QPoint &gMousePos);
+    // 立即应用尚未处理的缩放
+    void flushPendingResize();
+    // 合并缩放的帧间隔(毫秒)
+    int resizeFrameInterval() const;
+    // 拖动缩放开始，或停顿后继续
+    void beginLiveResize();
+    // 拖动缩放结束或停顿
+    void endLiveResize();
 
 private:
     FramelessHelperPrivate *d;
@@ -50,12 +108,29 @@ private:
     QPoint m_ptDragPos;
     double m_dLeftScale; // 鼠标位置距离最窗口最左边的距离占整个宽度的比例
     int m_nRightLength; // 鼠标位置距离最窗口最右边的距离
-    CursorPosCalculator m_pressedMousePos;
-    CursorPosCalculator m_moveMousePos;
+    HitTester m_hitTester;
+    HitTester::Region m_pressedRegion; // 鼠标按下时所在的区域
     bool m_bLeftButtonPressed;
     bool m_bLeftButtonTitlePressed;
     bool m_bCursorShapeChanged;
+    Qt::CursorShape m_cursorShape;      // 当前设置的鼠标样式
+    HitTester::Region m_cursorRegion;   // 当前鼠标样式对应的区域
+    QRect m_frameRect;
+    bool m_bMaximizedOrFullScreen;
+    bool m_bFrameStateValid;
     Qt::WindowFlags m_windowFlags;
+    QTimer *m_pResizeTimer;
+    QElapsedTimer m_resizeClock; // 距上一次应用缩放的时间
+    QPoint m_ptPendingResizePos;
+    bool m_bResizePending;
+    int m_nResizeInterval;
+    QTimer *m_pSettleTimer;
+    bool m_bLiveResizing;
+    QPoint m_ptLastMovePos;    // 最近一次处理的鼠标移动的全局位置
+    bool m_bLastMovePosValid;
+    FramelessEventStatistics m_eventStatistics;
+    QElapsedTimer m_statisticsClock;
+    FrameProfiler *m_pFrameProfiler;
 };
 
 #endif // WIDGETDATA_H
@@ -10,8 +10,13 @@
 
 #include "framelesswindow_global.h"
 #include "borderimage.h"
+#include "shadowtilecache.h"
+#include "roundedmask.h"
+#include "screentracker.h"
+#include "frameprofiler.h"
 #include "framelesshelper.h"
 #include "titlebar.h"
+#include "themeengine.h"
 #include <QtWidgets>
 #include <QDialog>
 #include <QMessageBox>
@@ -21,6 +26,20 @@
 #include <QPainter>
 #include <QEventLoop>
 
+/**
+ * @brief The WidgetShadowPaintStatistics struct
+ *  窗口背景绘制统计，用于确认局部刷新减少的像素
+ */
+struct WidgetShadowPaintStatistics
+{
+    WidgetShadowPaintStatistics()
+        : frames(0), lastFramePixels(0), totalPixels(0), ringSkippedFrames(0) {}
+
+    qint64 frames;            //绘制次数
+    qint64 lastFramePixels;   //最近一次绘制的像素数
+    qint64 totalPixels;       //累计绘制的像素数
+    qint64 ringSkippedFrames; //只需刷新客户区、跳过阴影环的次数
+};
 
 template <class T>
 class WidgetShadow : public T
@@ -31,14 +50,22 @@ public:
     WidgetShadow(QWidget *parent = nullptr)
         :T(parent)
         , m_pHelper(Q_NULLPTR)
+        , m_pScreenTracker(Q_NULLPTR)
         , m_pTitleBar(Q_NULLPTR)
         , m_pMainWindow(Q_NULLPTR)
         , m_pMainLayout(Q_NULLPTR)
         , m_pFrameLessWindowLayout(Q_NULLPTR)
         , m_pCentralWdiget(new QWidget(this))
-        , m_clientDrawType(kTopLeftToBottomRight)
         , m_redrawPixmap(true)
         , m_drawedPixmap(Q_NULLPTR)
+        , m_bSolidClient(false)
+        , m_nThemeBorderWidth(0)
+        , m_clientDrawType(kTopLeftToBottomRight)
+        , m_backingStoreMode(kFullBackingStore)
+        , m_bLowQualityLiveResize(false)
+        , m_bLiveResizing(false)
+        , m_nCornerRadius(0)
+        , m_bCompositorAlpha(false)
     {
 
         resize(800, 600);
@@ -57,10 +84,11 @@ public:
 
         setWindowFlags(Qt::FramelessWindowHint | windowFlags());
         setAttribute(Qt::WA_TranslucentBackground);
+        //主题中本窗口的背景和边框画在客户区，不交给样式表引擎
+        this->setProperty(ThemeEngine::clientProperty(ThemeEngine::ClientPainting), true);
 
-        m_pTitleBar = new TitleBar(this);
+        m_pTitleBar = AbstractTitleBar::create(this);
         installEventFilter(m_pTitleBar);//标题栏不注册事件，注册本窗口把事件转发到标题栏
-        setTitleHeight(m_pTitleBar->height());
 
         m_pFrameLessWindowLayout = new QVBoxLayout(m_pMainWindow);
         m_pFrameLessWindowLayout->addWidget(m_pTitleBar);
@@ -68,8 +96,27 @@ public:
         m_pFrameLessWindowLayout->setSpacing(0);
         m_pFrameLessWindowLayout->setContentsMargins(0, 0, 0, 0);
 
+        //跟踪窗口所在屏幕，最大化按所在屏幕的可用区域
+        m_pScreenTracker = new ScreenTracker(this);
+        QObject::connect(m_pScreenTracker, &ScreenTracker::availableGeometryChanged, this, [this](const QRect &rect) {
+            if(this->isMaximized()) {
+                this->setGeometry(rect);
+            }
+        });
+
         m_pHelper = new FramelessHelper(this);
         m_pHelper->activateOn(this);  //激活当前窗体
+        m_pHelper->setFrameProfiler(this, &m_frameProfiler);
+        setTitleHeight(m_pTitleBar->height());
+
+        //拖动缩放结束或停顿后，补一次高质量绘制
+        QObject::connect(m_pHelper, &FramelessHelper::liveResizeChanged, this, [this](QWidget *, bool active) {
+            m_bLiveResizing = active;
+            if(!active && m_bLowQualityLiveResize) {
+                m_redrawPixmap = true;
+                this->update();
+            }
+        });
 
         //设置边框宽度
         m_pHelper->setBorderWidth((m_borderImage.margin().top()+m_borderImage.margin().left()+m_borderImage.margin().right()+m_borderImage.margin().bottom())/4);
@@ -96,17 +143,35 @@ public:
         kTopRightToBottomLeft       //右上到左下
     };
 
+    enum BackingStoreMode {
+        kFullBackingStore = 0,      //整窗缓存阴影和客户区背景(默认)
+        kBorderRingBackingStore     //只使用共享的阴影环切片，客户区直接填充
+    };
+
     /**
      * @brief setStyleSheetFile
-     * @note 设置QSS样式文件
+     * @note 设置QSS样式文件，文件内容由ThemeEngine缓存，但每个窗口仍由样式表引擎解析和polish。
+     *  修改文件后需要ThemeEngine::clear()才会重新读取
      * @param file
      */
     void setStyleSheetFile(const QString &file)
     {
-        QFile qss(file);
-        qss.open(QFile::ReadOnly);
-        this->setStyleSheet(qss.readAll());
-        qss.close();
+        QSharedPointer<const Theme> theme = ThemeEngine::theme(file);
+        //不再使用setTheme设置的主题
+        ThemeEngine::apply(this, QSharedPointer<const Theme>());
+        this->setStyleSheet(theme ? theme->styleSheet() : QString());
+    }
+
+    /**
+     * @brief setTheme
+     * @note 使用ThemeEngine编译好的主题代替setStyleSheetFile，同一个文件只解析一次、所有窗口共享，
+     *  能映射的规则直接设置为调色板和属性，不经过样式表引擎，其余规则仍交给样式表引擎。
+     *  本窗口的背景色和边框画在客户区，背景色优先于setClientColor、setClientImage
+     * @param file
+     */
+    void setTheme(const QString &file)
+    {
+        ThemeEngine::apply(this, ThemeEngine::theme(file));
     }
 
     /**
@@ -120,6 +185,16 @@ public:
         m_pHelper->setTitleHeight(h);
     }
 
+    /**
+     * @brief hitTester
+     * @note 本窗口的命中测试，可以注册额外的标题栏区域，或标题栏中不能拖动的区域
+     * @return
+     */
+    HitTester *hitTester() const
+    {
+        return m_pHelper->hitTester(const_cast<WidgetShadow *>(this));
+    }
+
     /**
      * @brief setWidgetMovalbe
      * @note 设置窗口是否可移动，默认可移动
@@ -140,6 +215,39 @@ public:
         m_pHelper->setWidgetResizable(resizable);
     }
 
+    /**
+     * @brief setResizeCoalescing
+     * @note 设置是否合并缩放，开启后每个帧间隔最多改变一次窗口大小
+     * @param enabled
+     * @param frameInterval 帧间隔(毫秒)，0表示按屏幕刷新率
+     */
+    void setResizeCoalescing(bool enabled = true, int frameInterval = 0)
+    {
+        m_pHelper->setResizeCoalescing(enabled, frameInterval);
+    }
+
+    /**
+     * @brief setLowQualityLiveResize
+     * @note 设置拖动边框缩放时是否使用低质量绘制：客户区直接填充，阴影的四条边用纯色填充、不拉伸切片，
+     *  松开鼠标或停顿后再做一次完整质量的绘制。只对纯色、无圆角的客户区生效，
+     *  背景图片和圆角仍按完整质量绘制
+     * @param enabled
+     */
+    void setLowQualityLiveResize(bool enabled = true)
+    {
+        m_bLowQualityLiveResize = enabled;
+    }
+
+    /**
+     * @brief framelessHelper
+     * @note 窗口的FramelessHelper，可以连接liveResizeChanged信号在缩放时降低内容的绘制细节
+     * @return
+     */
+    FramelessHelper *framelessHelper() const
+    {
+        return m_pHelper;
+    }
+
     /**
      * @brief setMinimumVisible
      * @note 设置窗口标题栏最小化按钮是否可见
@@ -204,6 +312,29 @@ public:
         m_borderImage.setPixmap(image);
         m_borderImage.setBorder(border);
         m_borderImage.setMargin(margin);
+        m_shadowTiles.clear();
+        m_redrawPixmap = true;
+        update();
+    }
+
+    /**
+     * @brief setShadow
+     * @note 程序化生成阴影，替换边框图片
+     * @param radius 模糊半径
+     * @param color 阴影颜色
+     * @param spread 模糊前阴影向外扩展的像素
+     */
+    void setShadow(int radius, const QColor &color = QColor(0, 0, 0, 80), int spread = 0)
+    {
+        m_borderImage.setShadow(radius, color, spread);
+        m_shadowTiles.clear();
+        m_redrawPixmap = true;
+
+        const QMargins &m = m_borderImage.margin();
+        if(!m_pMainLayout->contentsMargins().isNull()) {
+            m_pMainLayout->setContentsMargins(m);
+        }
+        m_pHelper->setBorderWidth((m.top() + m.left() + m.right() + m.bottom()) / 4);
         update();
     }
 
@@ -215,6 +346,8 @@ public:
     void setClientImage(const QString &image)
     {
         m_clientPixmap.load(image);
+        m_bSolidClient = false;
+        m_redrawPixmap = true;
         update();
     }
 
@@ -230,6 +363,9 @@ public:
         QPainter painter(&pixmap); //创建一直画笔
         painter.fillRect(0,0,1,1, color);
         m_clientPixmap = pixmap;
+        m_clientColor = color;
+        m_bSolidClient = true;
+        m_redrawPixmap = true;
 
         update();
     }
@@ -248,6 +384,56 @@ public:
         m_clientDrawType = type;
     }
 
+    /**
+     * @brief setBackingStoreMode
+     * @note 设置背景缓存方式。kBorderRingBackingStore不再分配整窗大小的图像，
+     *  缩放、最大化时也不会重新分配
+     * @param mode
+     */
+    void setBackingStoreMode(BackingStoreMode mode)
+    {
+        if(m_backingStoreMode == mode) {
+            return;
+        }
+
+        m_backingStoreMode = mode;
+        if(mode == kBorderRingBackingStore) {
+            delete m_drawedPixmap;
+            m_drawedPixmap = Q_NULLPTR;
+        }
+        m_redrawPixmap = true;
+        update();
+    }
+    inline BackingStoreMode backingStoreMode() const
+    {
+        return m_backingStoreMode;
+    }
+
+    /**
+     * @brief backingStoreBytes
+     * @note 本窗口背景缓存当前占用的字节数
+     * @return
+     */
+    qint64 backingStoreBytes() const
+    {
+        if(!m_drawedPixmap) {
+            return 0;
+        }
+        return qint64(m_drawedPixmap->width()) * m_drawedPixmap->height() * m_drawedPixmap->depth() / 8;
+    }
+
+    /**
+     * @brief backingStoreBytesSaved
+     * @note 与整窗缓存相比节省的字节数(按32位色深、当前窗口大小计算)。
+     *  整窗缓存和invalidateBackingStore一样按逻辑像素分配，不乘设备像素比
+     * @return
+     */
+    qint64 backingStoreBytesSaved() const
+    {
+        const qint64 full = qint64(this->width()) * this->height() * 4;
+        return qMax(Q_INT64_C(0), full - backingStoreBytes());
+    }
+
     /**
      * @brief hideTitleBar
      * @note 不显示标题栏
@@ -268,6 +454,67 @@ public:
         m_pTitleBar->hideTitleIcon();
     }
 
+    /**
+     * @brief shadowTiles
+     * @note 当前边框图片和设备像素比对应的共享阴影切片
+     * @return
+     */
+    const ShadowTiles &shadowTiles()
+    {
+        const qreal dpr = this->devicePixelRatioF();
+        if(!m_shadowTiles || !qFuzzyCompare(m_shadowTiles->devicePixelRatio(), dpr)) {
+            m_shadowTiles = ShadowTileCache::acquire(m_borderImage, dpr);
+        }
+        return *m_shadowTiles;
+    }
+
+    /**
+     * @brief setCornerRadius
+     * @note 设置客户区圆角半径，默认0(直角)。
+     *  有合成器时直接画出圆角，否则按客户区的圆角设置窗口遮罩，这时不显示阴影
+     * @param radius
+     */
+    void setCornerRadius(int radius)
+    {
+        radius = qMax(0, radius);
+        if(m_nCornerRadius == radius) {
+            return;
+        }
+
+        m_nCornerRadius = radius;
+        m_redrawPixmap = true;
+        updateMask();
+        update();
+    }
+    inline int cornerRadius() const
+    {
+        return m_nCornerRadius;
+    }
+
+    /**
+     * @brief paintStatistics
+     * @note 背景绘制统计
+     * @return
+     */
+    const WidgetShadowPaintStatistics &paintStatistics() const
+    {
+        return m_paintStatistics;
+    }
+    void resetPaintStatistics()
+    {
+        m_paintStatistics = WidgetShadowPaintStatistics();
+    }
+
+    /**
+     * @brief frameProfiler
+     * @note 绘制、缩放、拖动各阶段的耗时直方图，FrameProfiler::setEnabled(true)后开始统计
+     * @return
+     */
+    FrameProfiler *frameProfiler()
+    {
+        return &m_frameProfiler;
+    }
+
     /**
      * @brief 除去边框后的客户区rect
      * @return
@@ -367,115 +614,395 @@ protected:
             return;
         }
 
+        FrameProfilerScope profile(&m_frameProfiler, FrameProfiler::Resize);
         m_redrawPixmap = true;
 
-        //判断是否最大化
+        //判断是否最大化，按窗口所在屏幕的可用区域(缓存)判断
         //这里没有使用 isMaximized因为有时候不准确
-        if(QApplication::desktop()->availableGeometry().width() == geometry().width() && \
-           QApplication::desktop()->availableGeometry().height() == geometry().height()) {
+        if(m_pScreenTracker->availableGeometry().size() == this->geometry().size()) {
             //无圆角,并禁止改变窗口大小
             this->clearMask();
             //最大化后，无边框无边距
+            FrameProfilerScope profileMargins(&m_frameProfiler, FrameProfiler::ResizeMargins);
             m_pMainLayout->setContentsMargins(0, 0, 0, 0);
             return;
 
         } else {
             //恢复窗口的边框边距
             if(m_pMainLayout->contentsMargins().isNull()) {
+                FrameProfilerScope profileMargins(&m_frameProfiler, FrameProfiler::ResizeMargins);
                 m_pMainLayout->setContentsMargins(m_borderImage.margin());
             }
         }
 
-#if 1
-        //圆角窗口
-        QBitmap  pixmap(event->size());  //生成一张位图
-        QPainter painter(&pixmap);  //QPainter用于在位图上绘画
-        // 圆角平滑
-        painter.setRenderHints(QPainter::Antialiasing, true);
+        FrameProfilerScope profileMask(&m_frameProfiler, FrameProfiler::ResizeMask);
+        updateMask();
+    }
+
+    virtual bool event(QEvent *event)
+    {
+        //ThemeEngine把主题中本窗口的背景和边框设置为动态属性
+        if(event->type() == QEvent::DynamicPropertyChange) {
+            const QByteArray name = static_cast<QDynamicPropertyChangeEvent *>(event)->propertyName();
+            if(name == ThemeEngine::clientProperty(ThemeEngine::ClientBackground)
+                    || name == ThemeEngine::clientProperty(ThemeEngine::ClientBorderColor)
+                    || name == ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth)) {
+                updateThemeClient();
+            }
+        }
+        return T::event(event);
+    }
+
+    virtual void showEvent(QShowEvent *event)
+    {
+        //WA_TranslucentBackground总是让窗口格式带alpha，是否真正透明取决于桌面的合成器，
+        //查询可能要和窗口系统往返一次，只在显示时查询
+        m_bCompositorAlpha = RoundedMask::compositorRunning();
+        updateMask();
+        T::showEvent(event);
+    }
+
+    /**
+     * @brief hasCompositorAlpha
+     * @note 窗口的per-pixel alpha是否生效(有合成器)，有则圆角直接画出来，不需要遮罩
+     * @return
+     */
+    bool hasCompositorAlpha() const
+    {
+        return m_bCompositorAlpha;
+    }
 
-        //填充位图矩形框(用白色填充)
-        QRect r = this->rect();
-        painter.fillRect(r, Qt::color0);
-        painter.setBrush(Qt::color1);
-        //在位图上画圆角矩形(用黑色填充)
-        painter.drawRoundedRect(r, 0, 0);
-        painter.end();
+    /**
+     * @brief roundedCorners
+     * @note 当前是否需要圆角，最大化后无圆角
+     * @return
+     */
+    bool roundedCorners() const
+    {
+        return m_nCornerRadius > 0 && !this->isMaximized();
+    }
 
-        //使用setmask过滤即可
-        setMask(pixmap);
-#endif
+    /**
+     * @brief updateMask
+     * @note 更新圆角遮罩。半径为0或有per-pixel alpha时不设置遮罩。
+     *  遮罩只包含客户区：没有合成器时阴影边距画不出透明效果，连同阴影一起去掉
+     */
+    void updateMask()
+    {
+        if(!roundedCorners() || hasCompositorAlpha()) {
+            if(!this->mask().isEmpty()) {
+                this->clearMask();
+            }
+            return;
+        }
+
+        const QRect client = clientRect();
+        const QRegion region = RoundedMask::region(client.size(), m_nCornerRadius, this->devicePixelRatioF());
+        this->setMask(region.translated(client.topLeft()));
     }
 
     virtual void paintEvent(QPaintEvent *event)
     {
+        FrameProfilerScope profile(&m_frameProfiler, FrameProfiler::Paint);
+
+        //只处理需要刷新的区域，例如子控件hover只刷新子控件所在的一小块
+        const QRegion &region = event->region();
+        const bool clientOnly = clientRect().contains(region.boundingRect());
+
+        qint64 pixels = 0;
+        for(const QRect &r : region) {
+            pixels += qint64(r.width()) * r.height();
+        }
+        ++m_paintStatistics.frames;
+        m_paintStatistics.lastFramePixels = pixels;
+        m_paintStatistics.totalPixels += pixels;
+        if(clientOnly) {
+            ++m_paintStatistics.ringSkippedFrames;
+        }
+
+        if(m_bLowQualityLiveResize && m_bLiveResizing && solidClient() && !roundedCorners()) {
+            FrameProfilerScope profileBlit(&m_frameProfiler, FrameProfiler::PaintBlit);
+            QPainter painter(this);
+            painter.setClipRegion(region);
+            paintLiveResize(&painter);
+            //缩放结束后重建完整质量的缓存
+            m_redrawPixmap = true;
+            return;
+        }
+
+        if(m_backingStoreMode == kBorderRingBackingStore) {
+            FrameProfilerScope profileBlit(&m_frameProfiler, FrameProfiler::PaintBlit);
+            QPainter painter(this);
+            paintBorderRing(&painter, region, clientOnly);
+            return;
+        }
+
+        //整窗缓存失效时只记下失效的区域，每次只重画本次要刷新的那部分
         if(m_redrawPixmap || !m_drawedPixmap) {
             m_redrawPixmap = false;
-            qDeleteAll(m_alphaCache);
-            m_alphaCache.clear();
+            invalidateBackingStore();
+        }
+        const QRegion dirty = m_staleRegion & region;
+        if(!dirty.isEmpty()) {
+            FrameProfilerScope profileRebuild(&m_frameProfiler, FrameProfiler::PaintShadowRebuild);
+            rebuildBackingStore(dirty);
+            m_staleRegion -= dirty;
+        }
 
-            QRect rect = this->rect();
+        FrameProfilerScope profileBlit(&m_frameProfiler, FrameProfiler::PaintBlit);
+        QPainter painter(this);
+        for(const QRect &r : region) {
+            painter.drawPixmap(r, *m_drawedPixmap, r);
+        }
+    }
 
-            delete m_drawedPixmap; //it's safe to delete null
-            m_drawedPixmap = new QPixmap(rect.width(), rect.height());
-            m_drawedPixmap->fill(Qt::transparent);//Qt::black
+    /**
+     * @brief shadowRect
+     * @note 阴影环所在区域，最大化后放大使边框看不见
+     * @return
+     */
+    QRect shadowRect() const
+    {
+        QRect rect = this->rect();
+        if(this->isMaximized()) {
+            //考虑只有一个borderimage作为背景的情况，这种情况最大化后就需要用borderimage去掉边框后作为背景图
+            //把rect放大正好使边框看不见.
+            const QMargins &m  = m_borderImage.border();
+            rect.adjust(-m.left(), -m.top(), m.right(), m.bottom());
+        }
+        return rect;
+    }
+
+    /**
+     * @brief updateThemeClient
+     * @note 读取主题设置的客户区背景和边框，重画背景缓存
+     */
+    void updateThemeClient()
+    {
+        m_themeClientColor = qvariant_cast<QColor>(this->property(ThemeEngine::clientProperty(ThemeEngine::ClientBackground)));
+        m_themeBorderColor = qvariant_cast<QColor>(this->property(ThemeEngine::clientProperty(ThemeEngine::ClientBorderColor)));
+        m_nThemeBorderWidth = this->property(ThemeEngine::clientProperty(ThemeEngine::ClientBorderWidth)).toInt();
+        m_redrawPixmap = true;
+        this->update();
+    }
 
-            QPainter painter(m_drawedPixmap);
-            painter.setRenderHint(QPainter::Antialiasing, true);
+    /**
+     * @brief solidClient
+     * @note 客户区是否为纯色，主题设置了背景色时也是纯色
+     * @return
+     */
+    bool solidClient() const
+    {
+        return m_bSolidClient || m_themeClientColor.isValid();
+    }
+    QColor solidClientColor() const
+    {
+        return m_themeClientColor.isValid() ? m_themeClientColor : m_clientColor;
+    }
 
-            //边框背景图
-            const QMargins &m  = m_borderImage.border();
-            if(isMaximized()) {  //最大化后，无边框
-                //考虑只有一个borderimage作为背景的情况，这种情况最大化后就需要用borderimage去掉边框后作为背景图
-                //把rect放大正好使边框看不见.
-                rect.adjust(-m.left(), -m.top(), m.right(), m.bottom());
+    /**
+     * @brief drawClient
+     * @note 按客户区背景绘制方式把背景画到rect，不包括主题的边框
+     * @param painter
+     * @param rect
+     */
+    void drawClient(QPainter *painter, const QRect &rect)
+    {
+        const bool rounded = roundedCorners();
+        if(solidClient()) {
+            if(rounded) {
+                painter->save();
+                painter->setRenderHint(QPainter::Antialiasing, true);
+                painter->setPen(Qt::NoPen);
+                painter->setBrush(solidClientColor());
+                painter->drawRoundedRect(rect, m_nCornerRadius, m_nCornerRadius);
+                painter->restore();
+            } else {
+                painter->fillRect(rect, solidClientColor());
             }
-            qDrawBorderPixmap(&painter, rect, m, m_borderImage.pixmap());
-
-            //客户区图
-            const QPixmap& bmp = m_clientPixmap;
-            if(!bmp.isNull()) {
-
-                rect = clientRect();
-
-                QPixmap pixmap(rect.size());
-                {
-                    QPainter p(&pixmap);
-                    //1-从左上固定，右下拉伸；2-右上固定，左下拉伸
-                    switch(clientDrawType()) {
-                    case kTopLeftToBottomRight:
-                        drawTopLeft(&p, pixmap.rect(), bmp);
-                        break;
-                    case kTopRightToBottomLeft:
-                        drawTopRight(&p, pixmap.rect(), bmp);
-                        break;
-                    default:
-                        p.drawPixmap(pixmap.rect(), bmp);
-                        break;
-                    }
-                }
-
-                painter.setCompositionMode(QPainter::CompositionMode_DestinationOver);//CompositionMode_DestinationAtop,CompositionMode_SoftLight,CompositionMode_Multiply
-                painter.drawPixmap(rect.left(), rect.top(), pixmap);
+            return;
+        }
+
+        const QPixmap& bmp = m_clientPixmap;
+        if(bmp.isNull()) {
+            return;
+        }
+
+        painter->save();
+        if(rounded) {
+            QPainterPath path;
+            path.addRoundedRect(rect, m_nCornerRadius, m_nCornerRadius);
+            painter->setClipPath(path, Qt::IntersectClip);
+        } else {
+            painter->setClipRect(rect, Qt::IntersectClip);
+        }
+        painter->translate(rect.topLeft());
+        const QRect r(QPoint(0, 0), rect.size());
+        //1-从左上固定，右下拉伸；2-右上固定，左下拉伸
+        switch(clientDrawType()) {
+        case kTopLeftToBottomRight:
+            drawTopLeft(painter, r, bmp);
+            break;
+        case kTopRightToBottomLeft:
+            drawTopRight(painter, r, bmp);
+            break;
+        default:
+            painter->drawPixmap(r, bmp);
+            break;
+        }
+        painter->restore();
+    }
+
+    /**
+     * @brief drawClientBorder
+     * @note 画主题设置的客户区边框，和样式表一样画在rect内部，有圆角时沿圆角画
+     * @param painter
+     * @param rect
+     */
+    void drawClientBorder(QPainter *painter, const QRect &rect)
+    {
+        if(!m_themeBorderColor.isValid() || m_nThemeBorderWidth <= 0) {
+            return;
+        }
+
+        const qreal half = m_nThemeBorderWidth / 2.0;
+        const QRectF r = QRectF(rect).adjusted(half, half, -half, -half);
+        QPen pen(m_themeBorderColor, m_nThemeBorderWidth);
+        pen.setJoinStyle(Qt::MiterJoin);
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing, true);
+        painter->setPen(pen);
+        painter->setBrush(Qt::NoBrush);
+        if(roundedCorners()) {
+            const qreal radius = qMax(qreal(0), m_nCornerRadius - half);
+            painter->drawRoundedRect(r, radius, radius);
+        } else {
+            painter->drawRect(r);
+        }
+        painter->restore();
+    }
+
+    /**
+     * @brief paintBorderRing
+     * @note 只缓存阴影环时的绘制：先填充客户区，再在边框区域画共享的阴影切片
+     * @param painter
+     * @param region 需要刷新的区域
+     * @param clientOnly region是否只在客户区内，是则跳过阴影环
+     */
+    void paintBorderRing(QPainter *painter, const QRegion &region, bool clientOnly)
+    {
+        painter->setClipRegion(region);
+        if(solidClient() && !roundedCorners()) {
+            const QRect client = clientRect();
+            const QColor color = solidClientColor();
+            for(const QRect &r : region) {
+                painter->fillRect(r & client, color);
             }
+        } else {
+            drawClient(painter, clientRect());
         }
 
-        QPainter painter(this);
-        painter.drawPixmap(0, 0, *m_drawedPixmap);
+        if(!clientOnly) {
+            shadowTiles().draw(painter, shadowRect());
+        } else {
+            //客户区内只可能有中间的切片
+            shadowTiles().drawCenter(painter, shadowRect());
+        }
+        drawClientBorder(painter, clientRect());
+    }
+
+    /**
+     * @brief paintLiveResize
+     * @note 拖动缩放时的低质量绘制：纯色填充客户区，阴影环只拷贝四个角、四条边填充纯色。
+     *  只用于纯色、无圆角的客户区
+     * @param painter
+     */
+    void paintLiveResize(QPainter *painter)
+    {
+        painter->fillRect(clientRect(), solidClientColor());
+        shadowTiles().drawFlat(painter, shadowRect());
+        drawClientBorder(painter, clientRect());
+    }
+
+    /**
+     * @brief invalidateBackingStore
+     * @note 整窗背景缓存全部失效，大小改变时重新分配，内容在绘制时按需重画
+     */
+    void invalidateBackingStore()
+    {
+        qDeleteAll(m_alphaCache);
+        m_alphaCache.clear();
+
+        const QRect rect = this->rect();
+        if(!m_drawedPixmap || m_drawedPixmap->size() != rect.size()) {
+            delete m_drawedPixmap; //it's safe to delete null
+            m_drawedPixmap = new QPixmap(rect.width(), rect.height());
+            //新分配时填充一次，使图像带alpha通道
+            m_drawedPixmap->fill(Qt::transparent);
+        }
+        m_staleRegion = rect;
+    }
+
+    /**
+     * @brief rebuildBackingStore
+     * @note 重画整窗背景缓存中失效且需要刷新的区域，只在客户区内时跳过阴影环
+     * @param dirty
+     */
+    void rebuildBackingStore(const QRegion &dirty)
+    {
+        QPainter painter(m_drawedPixmap);
+        painter.setClipRegion(dirty);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for(const QRect &r : dirty) {
+            painter.fillRect(r, Qt::transparent);
+        }
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        painter.setRenderHint(QPainter::Antialiasing, true);
+
+        //边框背景图
+        if(clientRect().contains(dirty.boundingRect())) {
+            shadowTiles().drawCenter(&painter, shadowRect());
+        } else {
+            shadowTiles().draw(&painter, shadowRect());
+        }
+
+        //客户区图，画在阴影下面
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationOver);//CompositionMode_DestinationAtop,CompositionMode_SoftLight,CompositionMode_Multiply
+        drawClient(&painter, clientRect());
+
+        //主题的边框画在客户区背景上面
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        drawClientBorder(&painter, clientRect());
     }
 
 protected:
     FramelessHelper *m_pHelper;
-    TitleBar *m_pTitleBar;
+    ScreenTracker *m_pScreenTracker;
+    AbstractTitleBar *m_pTitleBar;
     QWidget *m_pMainWindow;
     QVBoxLayout *m_pMainLayout;
     QVBoxLayout *m_pFrameLessWindowLayout;
     QWidget *m_pCentralWdiget;
     bool m_redrawPixmap;          //是否需要重新创建客户区图像
     QPixmap *m_drawedPixmap;      //画好的背景图像
+    QRegion  m_staleRegion;       //背景图像中还没有按当前状态重画的区域
     QHash<QObject*, QPixmap*> m_alphaCache; //保存子控件alpha透明后的背景图
     QPixmap  m_clientPixmap;         //背景图片
+    QColor   m_clientColor;          //纯色背景
+    bool     m_bSolidClient;         //背景是否为纯色
+    QColor   m_themeClientColor;     //主题设置的背景色，无效时使用m_clientColor或背景图片
+    QColor   m_themeBorderColor;     //主题设置的客户区边框颜色，无效时没有边框
+    int      m_nThemeBorderWidth;    //主题设置的客户区边框宽度
     ClientDrawType m_clientDrawType; //背景图片绘制方式
+    BackingStoreMode m_backingStoreMode; //背景缓存方式
+    bool m_bLowQualityLiveResize;    //拖动缩放时是否低质量绘制
+    bool m_bLiveResizing;            //是否正在拖动缩放
+    WidgetShadowPaintStatistics m_paintStatistics; //绘制统计
+    FrameProfiler m_frameProfiler;   //各阶段耗时
+    int m_nCornerRadius;             //客户区圆角半径
+    bool m_bCompositorAlpha;         //显示时桌面是否有合成器
     BorderImage m_borderImage;       //阴影边框
+    QSharedPointer<const ShadowTiles> m_shadowTiles; //进程内共享的阴影切片
 };
 
 #endif // WIDGETSHADOW_H